@@ -1,28 +1,57 @@
+function render(j){
+  // normalize voltage to volts (compat: old firmwares might log mV)
+  let v = Number(j.busV);
+  if (Number.isFinite(v) && v > 60) v = v / 1000.0;
+
+  const i = Number(j.currmA);
+  const p = (Number.isFinite(v) && Number.isFinite(i)) ? v * (i/1000.0) : NaN;
+
+  document.getElementById('v').textContent = Number.isFinite(v) ? v.toFixed(3) : '—';
+  document.getElementById('i').textContent = Number.isFinite(i) ? i.toFixed(0) : '—';
+  document.getElementById('p').textContent = Number.isFinite(p) ? p.toFixed(3) : '—';
+  const now = new Date();
+  // peak values of the last logging interval (fast sampling)
+  const iMax = Number(j.currMaxmA), pMax = Number(j.powerMaxmW);
+  const peak = (Number(j.samples) > 1 && Number.isFinite(iMax))
+    ? ' · peak ' + iMax.toFixed(0) + ' mA / ' + (pMax/1000).toFixed(2) + ' W'
+    : '';
+  const e = j.energy;
+  const today = (e && Number.isFinite(Number(e.todaymWh)))
+    ? ' · today ' + (e.todaymWh/1000).toFixed(2) + ' Wh / ' + Number(e.todaymAh).toFixed(0) + ' mAh'
+    : '';
+  document.getElementById('info').textContent =
+  'Updated at ' + now.toLocaleTimeString([], {hour: '2-digit', minute: '2-digit', second: '2-digit'}) + peak + today;
+}
+
 async function fetchLatest(){
   try{
     const r = await fetch('/api/measure/latest', { cache:'no-store' });
     if(!r.ok) throw new Error(r.statusText);
-    const j = await r.json();
-
-    // normalize voltage to volts (compat: old firmwares might log mV)
-    let v = Number(j.busV);
-    if (Number.isFinite(v) && v > 60) v = v / 1000.0;
-
-    const i = Number(j.currmA);
-    const p = (Number.isFinite(v) && Number.isFinite(i)) ? v * (i/1000.0) : NaN;
-
-    document.getElementById('v').textContent = Number.isFinite(v) ? v.toFixed(3) : '—';
-    document.getElementById('i').textContent = Number.isFinite(i) ? i.toFixed(0) : '—';
-    document.getElementById('p').textContent = Number.isFinite(p) ? p.toFixed(3) : '—';
-    const now = new Date();
-    document.getElementById('info').textContent =
-    'Updated at ' + now.toLocaleTimeString([], {hour: '2-digit', minute: '2-digit', second: '2-digit'});
-  
+    render(await r.json());
   }catch(e){
     document.getElementById('info').textContent = 'No data';
   }
 }
 
 // poll roughly with sampling cadence
-setInterval(fetchLatest, 5000);
-fetchLatest();
\ No newline at end of file
+let pollTimer = null;
+function startPolling(){
+  if (pollTimer) return;
+  pollTimer = setInterval(fetchLatest, 5000);
+  fetchLatest();
+}
+
+// Push: the logger sends every new interval over one connection (/api/live).
+// The browser reconnects on its own; if the logger refuses (all live slots
+// busy, old firmware) fall back to polling.
+if ('EventSource' in window) {
+  const es = new EventSource('/api/live');
+  es.addEventListener('measure', ev => {
+    try { render(JSON.parse(ev.data)); } catch (e) {}
+  });
+  es.onerror = () => {
+    if (es.readyState === EventSource.CLOSED) startPolling();
+  };
+} else {
+  startPolling();
+}
\ No newline at end of file
@@ -1,27 +1,18 @@
 function $(sel){ return document.querySelector(sel); }
 
-function parseCSV(text){
+// Aggregated buckets from /api/logs/agg (mV / mA / mW) -> V / mA / W
+function parseAgg(text){
   const lines = text.trim().split(/\n+/);
-  if(!lines.length) return [];
   const out = [];
-  for(let i=1;i<lines.length;i++){
-    const L = lines[i].trim();
-    if(!L) continue;
-    const [e, v, iA] = L.split(';');
-    const epoch = Number(e);
-    if(!Number.isFinite(epoch)) continue;
-
-    // bus_V can be in V or mV (older/newer firmware); normalize to V
-    let bus = Number(v);
-    if (!Number.isFinite(bus)) continue;
-    if (bus > 60) bus = bus / 1000.0; // assume mV -> V
-
-    const currmA = Number(iA);
-    if (!Number.isFinite(currmA)) continue;
-
-    const powerW = bus * (currmA / 1000.0);
-
-    out.push({ t: epoch*1000, v: bus, i: currmA, p: powerW });
+  for(let k=1;k<lines.length;k++){
+    const f = lines[k].split(';').map(Number);
+    if(f.length < 11 || !Number.isFinite(f[0]) || !f[0]) continue;
+    out.push({
+      t: f[0]*1000, n: f[1],
+      v: f[4]/1000, vMin: f[2]/1000, vMax: f[3]/1000,
+      i: f[7],      iMin: f[5],      iMax: f[6],
+      p: f[10]/1000, pMin: f[8]/1000, pMax: f[9]/1000,
+    });
   }
   out.sort((a,b)=>a.t-b.t);
   return out;
@@ -49,13 +40,17 @@ function drawSeries(canvas, data, key, color, yUnit){
   const W = cw - left - right;
   const H = ch - top - bottom;
 
+  // per-bucket min/max band (if present)
+  const kMin = key + 'Min', kMax = key + 'Max';
+  const hasBand = (kMin in data[0]) && (kMax in data[0]);
+
   const xs = data[0].t, xe = data[data.length-1].t;
   let ymin = Infinity, ymax = -Infinity;
   for(const d of data){
-    const y = d[key];
-    if(!Number.isFinite(y)) continue;
-    if(y < ymin) ymin = y;
-    if(y > ymax) ymax = y;
+    const lo = hasBand ? d[kMin] : d[key];
+    const hi = hasBand ? d[kMax] : d[key];
+    if(Number.isFinite(lo) && lo < ymin) ymin = lo;
+    if(Number.isFinite(hi) && hi > ymax) ymax = hi;
   }
   if(!Number.isFinite(ymin) || !Number.isFinite(ymax) || ymin === ymax){
     ymin = (Number.isFinite(ymin) ? ymin : 0) - 1;
@@ -80,7 +75,22 @@ function drawSeries(canvas, data, key, color, yUnit){
     ctx.beginPath(); ctx.moveTo(left, yy); ctx.lineTo(left+W, yy); ctx.stroke();
   }
 
-  // line
+  // min/max band
+  if(hasBand){
+    ctx.fillStyle = color;
+    ctx.globalAlpha = 0.18;
+    ctx.beginPath();
+    data.forEach((d, k)=>{
+      const x = xmap(d.t), y = ymap(d[kMax]);
+      if(k === 0) ctx.moveTo(x, y); else ctx.lineTo(x, y);
+    });
+    for(let k=data.length-1;k>=0;k--) ctx.lineTo(xmap(data[k].t), ymap(data[k][kMin]));
+    ctx.closePath();
+    ctx.fill();
+    ctx.globalAlpha = 1;
+  }
+
+  // line (bucket mean)
   ctx.strokeStyle = color; ctx.lineWidth = 1.5; ctx.beginPath();
   let started = false;
   for(const d of data){
@@ -110,19 +120,86 @@ function drawSeries(canvas, data, key, color, yUnit){
   ctx.textAlign = 'start';
 }
 
+// Raw rows from /api/logs/range (epoch;bus_mV;curr_mA) -> V / mA / W
+function parseRange(text){
+  const lines = text.trim().split(/\n+/);
+  const out = [];
+  for(let k=1;k<lines.length;k++){
+    const f = lines[k].split(';').map(Number);
+    if(f.length < 3 || !Number.isFinite(f[0]) || !f[0]) continue;
+    const v = f[1]/1000, i = f[2];
+    out.push({ t: f[0]*1000, v, i, p: v*i/1000 });
+  }
+  return out;
+}
+
+// Series currently on screen: buckets plus where to continue in the raw log
+const view = { sec: null, rows: [], width: 0, points: 0, cursor: null };
+
+// Adds one raw row to the last bucket, or opens the next bucket on the same grid
+function mergeRow(r){
+  const rows = view.rows;
+  const last = rows[rows.length-1];
+  if (last && r.t < last.t) return;
+  if (last && r.t < last.t + view.width) {
+    const n = last.n + 1;
+    for (const k of ['v', 'i', 'p']) {
+      last[k] = (last[k]*last.n + r[k]) / n;
+      last[k+'Min'] = Math.min(last[k+'Min'], r[k]);
+      last[k+'Max'] = Math.max(last[k+'Max'], r[k]);
+    }
+    last.n = n;
+    return;
+  }
+  const t = last ? last.t + Math.floor((r.t - last.t) / view.width) * view.width : r.t;
+  rows.push({ t, n: 1, v: r.v, vMin: r.v, vMax: r.v, i: r.i, iMin: r.i, iMax: r.i, p: r.p, pMin: r.p, pMax: r.p });
+}
+
+// Full load: buckets for the whole window from /api/logs/agg
 async function loadRange(sec){
   const qs = sec === 'max' ? 'sec=max' : ('sec=' + String(sec|0));
-  const res = await fetch('/api/logs/range?' + qs, { cache:'no-store' });
+  // one bucket per pixel of the plot area: payload depends on chart width, not log length
+  const points = Math.max(10, ($('#cvV').clientWidth || 600) - 60);
+  const res = await fetch('/api/logs/agg?' + qs + '&points=' + points, { cache:'no-store' });
   if(!res.ok){
+    view.cursor = null;
     $('#info').textContent = 'No data (' + res.status + ')';
     return;
   }
-  const txt = await res.text();
-  const rows = parseCSV(txt);
+  view.rows = parseAgg(await res.text());
+  view.sec = sec;
+  view.points = points;
+  view.width = (Number(res.headers.get('X-Bucket-Seconds')) || 1) * 1000;
+  view.cursor = res.headers.get('X-Log-Cursor');
+  render();
+}
+
+// Poll: only rows logged since the last response, merged into the buckets
+async function updateRange(sec){
+  if (sec !== view.sec || !view.cursor) return loadRange(sec);
+  const res = await fetch('/api/logs/range?cursor=' + encodeURIComponent(view.cursor), { cache:'no-store' });
+  // rotated away or cleared in the meantime: start over
+  if (!res.ok || res.headers.get('X-Log-Reset')) return loadRange(sec);
+  const fresh = parseRange(await res.text());
+  view.cursor = res.headers.get('X-Log-Cursor') || view.cursor;
+  if (!fresh.length) return;
+
+  fresh.forEach(mergeRow);
+  if (sec !== 'max') {
+    const from = fresh[fresh.length-1].t - sec*1000;
+    while (view.rows.length && view.rows[0].t + view.width <= from) view.rows.shift();
+  }
+  // "max" keeps growing: rebuild at chart resolution once it gets too dense
+  if (view.rows.length > view.points * 1.25) return loadRange(sec);
+  render();
+}
 
+function render(){
+  const rows = view.rows;
   // meta
+  const samples = rows.reduce((s, r)=>s + r.n, 0);
   const span = rows.length ? ( (rows[rows.length-1].t - rows[0].t) / 1000 ) : 0;
-  $('#info').textContent = rows.length + ' points · span ≈ ' + Math.round(span/60) + ' min';
+  $('#info').textContent = samples + ' samples · ' + rows.length + ' points · span ≈ ' + Math.round(span/60) + ' min';
 
   // draw
   drawSeries($('#cvV'), rows, 'v', '#0b5fff', 'V');
@@ -192,7 +269,7 @@ function setup(){
   async function refresh() {
     if (inFlight) return;
     inFlight = true;
-    try { await loadRange(selectedSec); }
+    try { await updateRange(selectedSec); }
     catch(e){ /* ignore */ }
     finally { inFlight = false; }
   }
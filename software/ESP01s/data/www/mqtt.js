@@ -2,6 +2,12 @@ const serverInput = document.getElementById('mqtt-server');
 const portInput = document.getElementById('mqtt-port');
 const userInput = document.getElementById('mqtt-user');
 const passInput = document.getElementById('mqtt-pass');
+const onChangeInput = document.getElementById('mqtt-onchange');
+const dbVInput = document.getElementById('mqtt-db-v');
+const dbIInput = document.getElementById('mqtt-db-i');
+const dbPInput = document.getElementById('mqtt-db-p');
+const dbRelInput = document.getElementById('mqtt-db-rel');
+const heartbeatInput = document.getElementById('mqtt-heartbeat');
 const statusEl = document.getElementById('mqtt-status');
 const form = document.getElementById('mqtt-form');
 const chipIdEl = document.getElementById('chip-id');
@@ -22,6 +28,12 @@ async function loadConfig() {
     portInput.value = j.port || '';
     userInput.value = j.user || '';
     passInput.value = j.pass || '';
+    onChangeInput.checked = !!j.onChange;
+    dbVInput.value = j.dbV ?? 0;
+    dbIInput.value = j.dbI ?? 0;
+    dbPInput.value = j.dbP ?? 0;
+    dbRelInput.value = j.dbRel ?? 0;
+    heartbeatInput.value = j.heartbeat ?? 300;
     statusEl.textContent = 'Loaded';
   } catch (e) {
     statusEl.textContent = 'Load failed';
@@ -36,6 +48,12 @@ async function saveConfig(ev) {
     port: Number(portInput.value || 0),
     user: userInput.value.trim(),
     pass: passInput.value,
+    onChange: onChangeInput.checked,
+    dbV: Number(dbVInput.value || 0),
+    dbI: Number(dbIInput.value || 0),
+    dbP: Number(dbPInput.value || 0),
+    dbRel: Number(dbRelInput.value || 0),
+    heartbeat: Number(heartbeatInput.value || 300),
   };
 
   try {
@@ -1,24 +1,98 @@
 #pragma once
 
 // ==== Timing ====
-static const unsigned long SAMPLE_INTERVAL_MS = 5000; // 5 Sekunden
+static const unsigned long SAMPLE_INTERVAL_MS = 5000; // 5 Sekunden (Logintervall)
 
 // ==== I2C-Pins (ESP-01S) ====
 static const int PIN_SDA = 2;  // GPIO2
 static const int PIN_SCL = 0;  // GPIO0
 
-// ==== Logging (konservativ für ESP-01S 1MB Flash) ====
-// Zielgröße: ~64 KB Gesamt -> 4 Dateien à 16 KB
+// ==== Logging (ESP-01S 1MB Flash) ====
+// MAX_LOG_FILE_SIZE/MAX_LOG_FILES sind nur die Grundaufteilung: Startwerte,
+// Rückfall ohne LittleFS.info() und Verhältnis Rohdaten zu Stufen. Die
+// tatsächliche Größe bestimmt das Flash-Budget unten (LOG_FS_RESERVE,
+// LOG_AUTO_*); es vermehrt zuerst Dateien in der Grundgröße.
 static const char* LOG_DIR    = "/logs";
-static const char* LOG_PREFIX = "log_";      // log_0000.csv, log_0001.csv, ...
-static const char* LOG_EXT    = ".csv";
-static const size_t MAX_LOG_FILE_SIZE = 16 * 1024; // 16 KB pro Datei
-static const size_t MAX_LOG_FILES     = 4;         // max. 4 Dateien (gesamt ~64 KB)
+static const char* LOG_PREFIX = "log_";      // log_0000.bin, log_0001.bin, ...
+static const char* LOG_EXT    = ".bin";      // binäre Sätze à 8 Byte (siehe DataLogger.h)
+static const size_t MAX_LOG_FILE_SIZE = 16 * 1024; // Grundgröße je Datei
+static const size_t MAX_LOG_FILES     = 4;         // Grundanzahl (ohne Budget: ~64 KB)
+
+// Flash-Budget: beim Start aus LittleFS.info() bestimmt (freier Platz plus
+// eigene Logdateien, abzüglich Reserve) und im Verhältnis der Grundaufteilung
+// (MAX_LOG_* und Stufen unten) auf Rohdaten und Stufen verteilt. Reicht die
+// Dateianzahl nicht, wachsen die Dateien. Obergrenze/Reserve zur Laufzeit
+// über /api/logs/config, gespeichert in LOG_CONFIG_PATH.
+static const char* LOG_CONFIG_PATH       = "/logger.json";
+static const size_t LOG_FS_RESERVE       = 32 * 1024;  // MQTT-Queue (16 KB), Ereignisse (8 KB), Konfiguration, Energie
+static const size_t LOG_AUTO_MAX_FILES   = 16;         // je Stufe (RAM-Index)
+static const size_t LOG_AUTO_MAX_FILE_SIZE = 64 * 1024; // begrenzt die Dauer des Packens beim Rotieren
+
+// Volle Segmente beim Rotieren packen (Delta-of-Delta-Zeit, Wert-Deltas als
+// varint, siehe LogPack.h). Das Byte-Budget bleibt gleich, gepackt passen
+// aber entsprechend mehr Segmente hinein.
+static const bool LOG_PACK_SEGMENTS = true;
+
+// Schreibpuffer: Sätze sammeln und gebündelt schreiben (schont Flash/Metadaten).
+// Bei Stromausfall gehen höchstens die gepufferten Sätze verloren.
+static const size_t LOG_FLUSH_RECORDS      = 12;     // 12 Sätze = 1 min bei 5 s
+static const unsigned long LOG_FLUSH_MS    = 60000;  // spätestens nach 60 s schreiben
+
+// Rollup-Stufen: min/max/Mittel je Periode (24 Byte pro Satz) für lange Zeiträume.
+// Diagramme mit grober Auflösung lesen nur diese Dateien statt der Rohdaten.
+static const char* LOG_TIER1_PREFIX          = "m01_";  // m01_0000.bin, ...
+static const uint32_t LOG_TIER1_PERIOD_S     = 60;      // 1 min
+static const size_t LOG_TIER1_FILES          = 4;       // 4 x 4 KB ~ 11 h
+static const char* LOG_TIER2_PREFIX          = "m15_";  // m15_0000.bin, ...
+static const uint32_t LOG_TIER2_PERIOD_S     = 900;     // 15 min
+static const size_t LOG_TIER2_FILES          = 4;       // 4 x 4 KB ~ 7 Tage
+static const size_t LOG_TIER_FILE_SIZE       = 4 * 1024;
+
+// ==== Ereignisse ====
+// Regeln (Schwellen, Änderungsrate, PD-Stufenwechsel) prüfen jede schnelle
+// Abtastung; Treffer landen im Ereignislog, unter /api/events und per MQTT
+// auf <base>/event. Regeln zur Laufzeit über /api/events/rules.
+static const char* EVENT_CONFIG_PATH   = "/events.json";
+static const char* EVENT_DIR           = "/events";
+static const char* EVENT_PREFIX        = "ev_";      // ev_0000.bin, ...
+static const size_t EVENT_FILE_SIZE    = 4 * 1024;   // 21 Byte pro Ereignis (mit CRC)
+static const size_t EVENT_FILES        = 2;          // ~390 Ereignisse
+
+// ==== Energiezähler ====
+static const char* ENERGY_PATH = "/energy.json";
+static const unsigned long ENERGY_CHECKPOINT_MS = 5UL * 60UL * 1000UL; // alle 5 min sichern
 
 // ==== NTP / Zeitzone ====
 static const char* TZ_EU_BERLIN = "CET-1CEST,M3.5.0,M10.5.0/3";
 
-// ==== INA219-Korrektur (Adafruit-Referenz 100 mΩ vs. real 50 mΩ) ====
-static const float SHUNT_MILLIOHM      = 50.0f;   // deine Platine
-static const float INA219_REF_MILLIOHM = 100.0f;  // setCalibration_32V_2A() Annahme
-static const float INA219_CORR = INA219_REF_MILLIOHM / SHUNT_MILLIOHM; // = 2.0f
\ No newline at end of file
+// ==== INA219 ====
+static const float SHUNT_MILLIOHM = 50.0f;   // deine Platine; Strom = Shuntspannung / R
+// Schnelle Abtastung: Rohwerte alle 50 ms (20 Hz), je Logintervall verdichtet
+// (Mittel/Min/Max/Energie). Der Chip mittelt selbst 16 Wandlungen je Kanal
+// (je 8,5 ms), jede Abtastung sieht also frische Werte.
+static const uint16_t FAST_SAMPLE_MS    = 50;
+static const uint8_t  INA219_AVG_SAMPLES = 16;
+static const uint32_t I2C_CLOCK_HZ      = 400000;
+
+// ==== MQTT-Historie ====
+// Messwerte gehen zusätzlich gebündelt als JSON-Array nach <base>/history.
+// Ohne Broker werden sie gepuffert: RAM, danach rotierende Dateien.
+static const char* MQTT_QUEUE_DIR            = "/mqttq";
+static const size_t MQTT_QUEUE_FILE_SIZE     = 4 * 1024;  // 12 Byte pro Satz
+static const size_t MQTT_QUEUE_FILES         = 4;         // 4 x 4 KB ~ 1,9 h bei 5 s
+static const size_t MQTT_HISTORY_BATCH       = 20;        // Sätze pro Nachricht
+static const unsigned long MQTT_HISTORY_MAX_AGE_MS = 60000; // spätestens nach 60 s senden
+
+// ==== MQTT-State ====
+// Standard: jeder Messwert wird als State gesendet. Mit "onChange" in /mqtt.json
+// nur bei Änderung über die Totzone (absolut oder relativ, der größere Wert
+// zählt) und spätestens nach dem Heartbeat-Intervall.
+static const uint32_t MQTT_HEARTBEAT_S_DEFAULT = 300;     // 5 min
+static const uint32_t MQTT_HEARTBEAT_S_MAX     = 86400;   // 1 Tag
+
+// ==== MQTT-Verbindung ====
+// Wartezeit nach Fehlschlag: verdoppelt sich je Versuch (2 s, 4 s, ... bis
+// 5 min), davon zufällig 50..100 % damit nicht alle Geräte gleichzeitig kommen.
+static const uint32_t MQTT_RETRY_MIN_MS     = 2000;
+static const uint32_t MQTT_RETRY_MAX_MS     = 300000;
+static const uint32_t MQTT_PROBE_TIMEOUT_MS = 5000;   // DNS + TCP-Aufbau
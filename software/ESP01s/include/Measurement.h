@@ -10,4 +10,12 @@ struct Measurement {
   float currmA = 0;
   float powermW = 0;
   float loadV = 0;
+
+  // Statistik über das Logintervall (Mittelwerte stehen oben)
+  uint16_t samples = 0;
+  float busMinV = 0, busMaxV = 0;
+  float currMinmA = 0, currMaxmA = 0;
+  float powerMinmW = 0, powerMaxmW = 0;
+  float energymWh = 0;  // Energie im Intervall
+  float chargemAh = 0;  // Ladung im Intervall
 };
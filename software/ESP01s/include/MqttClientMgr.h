@@ -7,20 +7,35 @@
 #include <ArduinoJson.h>
 #include "Config.h"
 #include "Measurement.h"
+#include "MqttConfig.h"
+#include "MqttQueue.h"
+#include "NetProbe.h"
+
+class EnergyMeter;
+class EventDetector;
 
 class MqttClientMgr {
 public:
   MqttClientMgr();
 
-  void begin(const Measurement* latest);
+  void begin(const Measurement* latest, const EnergyMeter* energy = nullptr,
+             EventDetector* events = nullptr);
   void loop();
+  // New logging interval: publish state and queue it for the history topic
+  void enqueue(const Measurement& m);
   const String& lastLog() const;
+  // Shared settings; WebServerMgr saves through it, loop() picks up the change
+  MqttConfigStore& config() { return _config; }
 
 private:
-  void loadConfigIfNeeded();
+  void applyConfigIfChanged();
   bool connectIfNeeded();
+  void scheduleRetry();
   void publishDiscovery();
   void publishState();
+  bool stateChanged() const;
+  bool publishHistory();
+  bool publishEvent();
   void configureClient();
   String chipIdHex() const;
   void logLine(const String& line);
@@ -28,6 +43,8 @@ private:
   WiFiClient _wifi;
   PubSubClient _client;
   const Measurement* _latest = nullptr;
+  const EnergyMeter* _energy = nullptr;
+  EventDetector* _events = nullptr;
 
   String _server;
   uint16_t _port = 0;
@@ -35,15 +52,35 @@ private:
   String _pass;
   bool _configured = false;
 
-  unsigned long _lastConfigCheck = 0;
-  unsigned long _lastReconnectAttempt = 0;
-  unsigned long _lastPublish = 0;
+  MqttConfigStore _config;
+  uint32_t _configRev = 0;  // revision of _config last applied
+  // connection state machine: Down -> Probing (DNS + TCP in the background) -> Up
+  enum ConnPhase : uint8_t { Down, Probing, Up };
+  ConnPhase _phase = Down;
+  NetProbe _probe;
+  bool _stateDirty = false;
+  // report-by-exception: deadbands in V, mA, W and % of the last published value
+  bool _onChange = false;
+  float _deadbandV = 0;
+  float _deadbandI = 0;
+  float _deadbandP = 0;
+  float _deadbandRel = 0;
+  unsigned long _heartbeatMs = MQTT_HEARTBEAT_S_DEFAULT * 1000UL;
+  float _pubV = NAN, _pubI = NAN, _pubP = NAN;  // last published state
+  unsigned long _lastStateAt = 0;
+  bool _stateSent = false;   // false -> next state is published unconditionally
+  MqttQueue _queue;
+  bool _queueReady = false;
+  unsigned long _historySince = 0;  // millis() of the oldest unpublished RAM sample, 0 = none
   bool _discoveryPublished = false;
   String _lastLog;
   uint8_t _failCount = 0;
-  unsigned long _nextRetryAt = 0;
+  unsigned long _nextRetryAt = 0;  // millis() of the next attempt while Down
 
   String _clientId;
   String _baseTopic;
   String _availabilityTopic;
+  String _stateTopic;
+  String _historyTopic;
+  String _eventTopic;
 };
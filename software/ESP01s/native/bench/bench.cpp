@@ -0,0 +1,237 @@
+// Host-Benchmarks für Logger und Log-Auslieferung.
+//
+//   pio run -e native && .pio/build/native/program [tage]
+//
+// Erzeugt synthetische Logs (Standard: 3 Tage im 5-s-Raster) mit den
+// Einstellungen aus Config.h und misst je Operation Laufzeit, Heap-
+// Allokationen und Dateisystemzugriffe. Die Zahlen sind nur untereinander
+// vergleichbar (Host statt ESP8266), taugen aber als Regressionsmaßstab.
+// pio test baut src/ mit, bringt aber eigene Programme mit
+#ifndef UNIT_TEST
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <ESP8266WebServer.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include "Config.h"
+#include "DataLogger.h"
+#include "WebServerMgr.h"
+
+// ---- Allokationszähler (globaler operator new) ----
+
+static unsigned long g_allocs = 0;
+static unsigned long g_allocBytes = 0;
+
+void* operator new(size_t n) {
+  g_allocs++;
+  g_allocBytes += n;
+  if (void* p = malloc(n ? n : 1)) return p;
+  throw std::bad_alloc();
+}
+void* operator new[](size_t n) { return operator new(n); }
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+
+// ---- Messung ----
+
+struct Probe {
+  std::chrono::steady_clock::time_point t0;
+  unsigned long allocs, allocBytes, opens, bytesRead, bytesWritten;
+
+  void start() {
+    allocs = g_allocs;
+    allocBytes = g_allocBytes;
+    opens = shimFsStats.opens;
+    bytesRead = shimFsStats.bytesRead;
+    bytesWritten = shimFsStats.bytesWritten;
+    t0 = std::chrono::steady_clock::now();
+  }
+
+  // Zeile der Ergebnistabelle; 'out' = gesendete Bytes je Operation (0 = keine Antwort)
+  void report(const char* name, unsigned long ops, unsigned long outBytes = 0) const {
+    const double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    const double n = ops ? (double)ops : 1.0;
+    printf("%-34s %8lu %10.2f %12.0f %9.2f %9.1f %8.3f %10.0f %10.0f\n",
+           name, ops, sec * 1e6 / n, ops / (sec > 0 ? sec : 1e-9),
+           (g_allocs - allocs) / n, (g_allocBytes - allocBytes) / n,
+           (shimFsStats.opens - opens) / n,
+           (shimFsStats.bytesRead - bytesRead + shimFsStats.bytesWritten - bytesWritten) / n,
+           outBytes / n);
+  }
+};
+
+static void header() {
+  printf("%-34s %8s %10s %12s %9s %9s %8s %10s %10s\n",
+         "operation", "ops", "us/op", "ops/s", "allocs/op", "heapB/op", "opens/op", "fsB/op", "outB/op");
+}
+
+// ---- synthetische Daten ----
+
+// PD-typischer Verlauf: Spannungsstufen 5/9/15/20 V, Ladestrom mit Rauschen
+static void synth(Measurement& m, uint32_t epoch, uint32_t i) {
+  static const float levels[] = { 5.0f, 9.0f, 15.0f, 20.0f };
+  const float v = levels[(i / 720) % 4] + (random(0, 21) - 10) * 0.001f;
+  const float a = 300.0f + (i % 360) * 2.0f + random(0, 50);
+  m.epoch = epoch;
+  m.ms = millis();
+  m.busV = v;
+  m.currmA = a;
+  m.powermW = v * a;
+  m.samples = 100;
+  m.busMinV = v - 0.02f;
+  m.busMaxV = v + 0.02f;
+  m.currMinmA = a - 40.0f;
+  m.currMaxmA = a + 120.0f;
+  m.powerMinmW = m.busMinV * m.currMinmA;
+  m.powerMaxmW = m.busMaxV * m.currMaxmA;
+  m.energymWh = m.powermW * (SAMPLE_INTERVAL_MS / 3600000.0f);
+  m.chargemAh = a * (SAMPLE_INTERVAL_MS / 3600000.0f);
+}
+
+static void setupLogger(DataLogger& lg) {
+  lg.setFlushPolicy(LOG_FLUSH_RECORDS, LOG_FLUSH_MS);
+  lg.setPacking(LOG_PACK_SEGMENTS);
+  lg.setConfigPath(LOG_CONFIG_PATH);
+  lg.addTier(LOG_TIER1_PREFIX, LOG_TIER1_PERIOD_S, LOG_TIER_FILE_SIZE, LOG_TIER1_FILES);
+  lg.addTier(LOG_TIER2_PREFIX, LOG_TIER2_PERIOD_S, LOG_TIER_FILE_SIZE, LOG_TIER2_FILES);
+}
+
+// Statisches Asset samt Manifest wie von scripts/www_assets.py erzeugt
+static const char* kBenchEtag = "0123456789abcdef";
+
+static void installAssets() {
+  LittleFS.mkdir("/www");
+  File f = LittleFS.open("/www/app.js.gz", "w");
+  for (int i = 0; i < 2800; ++i) f.write((uint8_t)random(0, 256));
+  f.close();
+  f = LittleFS.open("/www/assets.json", "w");
+  f.printf("{\"assets\":[{\"uri\":\"/app.js\",\"file\":\"/www/app.js.gz\","
+           "\"etag\":\"%s\",\"type\":\"application/javascript\"}]}", kBenchEtag);
+  f.close();
+}
+
+// ---- HTTP ----
+
+// Log-Antworten laufen in WebServerMgr::loop() weiter: pumpen, bis alle fertig sind
+static void request(WebServerMgr& web, ESP8266WebServer& srv, const char* name, const String& uri,
+                    const std::vector<std::pair<String, String>>& args, unsigned long reps,
+                    const std::vector<std::pair<String, String>>& headers = {}) {
+  unsigned long out = 0;
+  Probe p;
+  p.start();
+  for (unsigned long r = 0; r < reps; ++r) {
+    WiFiClient c = srv.shimRequest(HTTP_GET, uri, args, headers);
+    do web.loop(); while (web.activeStreams());
+    out += c.context()->sent;
+  }
+  p.report(name, reps, out);
+}
+
+int main(int argc, char** argv) {
+  const int days = (argc > 1) ? atoi(argv[1]) : 3;
+  const uint32_t samples = (uint32_t)max(days, 1) * 86400UL / (SAMPLE_INTERVAL_MS / 1000);
+
+  Serial.setQuiet(true);
+  LittleFS.setRoot(".pio/bench_fs");
+  if (!LittleFS.format()) {
+    printf("cannot create .pio/bench_fs\n");
+    return 1;
+  }
+  randomSeed(42);
+
+  // 1) append über mehrere Tage; Aufrufe mit Rotation getrennt ausweisen
+  DataLogger lg;
+  setupLogger(lg);
+  if (!lg.begin(LOG_DIR, LOG_PREFIX, LOG_EXT, MAX_LOG_FILE_SIZE, MAX_LOG_FILES)) {
+    printf("logger init failed\n");
+    return 1;
+  }
+
+  // Grenzen nach dem Flash-Budget (Shim-Dateisystem: 1 MB)
+  printf("PD-Logger host benchmark: %d day(s), %lu samples, %u B/file x %u raw files\n\n",
+         days, (unsigned long)samples, (unsigned)lg.raw().maxFileSize(), (unsigned)lg.raw().maxFiles());
+  header();
+
+  const uint32_t t0 = (uint32_t)time(nullptr) - samples * (SAMPLE_INTERVAL_MS / 1000);
+  Measurement m;
+  double rotUs = 0;
+  unsigned long rotations = 0;
+  Probe all;
+  all.start();
+  for (uint32_t i = 0; i < samples; ++i) {
+    synth(m, t0 + i * (SAMPLE_INTERVAL_MS / 1000), i);
+    const int before = lg.raw().segment(lg.raw().segmentCount() - 1).index;
+    const auto a = std::chrono::steady_clock::now();
+    lg.append(m, String());
+    const auto b = std::chrono::steady_clock::now();
+    if (lg.raw().segment(lg.raw().segmentCount() - 1).index != before) {
+      rotations++;
+      rotUs += std::chrono::duration<double, std::micro>(b - a).count();
+    }
+    shimAdvanceMillis(SAMPLE_INTERVAL_MS);
+    lg.loop();
+  }
+  lg.flush();
+  all.report("append (incl. flush/rotation)", samples);
+  printf("%-34s %8lu %10.2f\n", "  thereof append with rotation", rotations, rotations ? rotUs / rotations : 0.0);
+  {
+    const LogStore& raw = lg.raw();
+    printf("%-34s %8.1f h in %u file(s), %lu B\n", "  raw history retained",
+           (raw.lastEpoch() - raw.firstEpoch()) / 3600.0, (unsigned)raw.segmentCount(),
+           (unsigned long)raw.totalBytes());
+  }
+
+  // 2) Neustart: Segment-Index aus dem Verzeichnis aufbauen
+  {
+    const unsigned long reps = 50;
+    Probe p;
+    p.start();
+    for (unsigned long r = 0; r < reps; ++r) {
+      DataLogger again;
+      setupLogger(again);
+      again.begin(LOG_DIR, LOG_PREFIX, LOG_EXT, MAX_LOG_FILE_SIZE, MAX_LOG_FILES);
+    }
+    p.report("begin (index build)", reps);
+  }
+
+  // 3) Dateiliste
+  {
+    const unsigned long reps = 2000;
+    String json;
+    Probe p;
+    p.start();
+    for (unsigned long r = 0; r < reps; ++r) lg.listFilesJSON(json);
+    p.report("listFilesJSON", reps, json.length() * reps);
+  }
+
+  // 4) Auslieferung über die HTTP-Handler
+  installAssets();
+  WebServerMgr web(80);
+  web.begin(&m, &lg, nullptr, nullptr);
+  ESP8266WebServer& srv = *ESP8266WebServer::shimLast();
+  srv.shimKeepOutput(false); // Heap-Zahlen ohne den Sendepuffer des Host-Clients
+
+  request(web, srv, "GET /api/logs",                 "/api/logs", {}, 500);
+  request(web, srv, "GET range sec=600",             "/api/logs/range", { { "sec", "600" } }, 200);
+  request(web, srv, "GET range sec=3600",            "/api/logs/range", { { "sec", "3600" } }, 100);
+  request(web, srv, "GET range sec=max",             "/api/logs/range", { { "sec", "max" } }, 20);
+  request(web, srv, "GET range sec=max format=bin",  "/api/logs/range", { { "sec", "max" }, { "format", "bin" } }, 20);
+  request(web, srv, "GET agg sec=3600 points=600",   "/api/logs/agg", { { "sec", "3600" }, { "points", "600" } }, 100);
+  request(web, srv, "GET agg sec=86400 points=600",  "/api/logs/agg", { { "sec", "86400" }, { "points", "600" } }, 100);
+  request(web, srv, "GET agg sec=max points=600",    "/api/logs/agg", { { "sec", "max" }, { "points", "600" } }, 100);
+  request(web, srv, "GET stats sec=86400",           "/api/logs/stats", { { "sec", "86400" } }, 20);
+  request(web, srv, "GET download (1 file, CSV)",    "/api/logs/download", { { "name", lg.raw().segmentPath(0) } }, 50);
+  request(web, srv, "GET download_all",              "/api/logs/download_all", {}, 10);
+  request(web, srv, "GET /app.js (gzip)",            "/app.js", {}, 500);
+  request(web, srv, "GET /app.js If-None-Match",     "/app.js", {}, 2000,
+          { { "If-None-Match", String("\"") + kBenchEtag + "\"" } });
+
+  printf("\nfs totals: opens=%lu reads=%lu writes=%lu removes=%lu dirScans=%lu\n",
+         shimFsStats.opens, shimFsStats.reads, shimFsStats.writes, shimFsStats.removes, shimFsStats.dirScans);
+  return 0;
+}
+#endif // UNIT_TEST
@@ -0,0 +1,4 @@
+#pragma once
+// Host-Ersatz: SensorINA219 spricht die Register selbst über Wire an
+#include <Wire.h>
+class Adafruit_INA219 { public: bool begin(TwoWire*) { return true; } void setCalibration_32V_2A() {} };
@@ -0,0 +1,40 @@
+#include <Arduino.h>
+#include <chrono>
+#include <random>
+
+HardwareSerial Serial;
+EspClass ESP;
+
+static unsigned long s_offsetMs = 0;
+
+static unsigned long long hostMicros() {
+  using namespace std::chrono;
+  static const auto t0 = steady_clock::now();
+  return (unsigned long long)duration_cast<microseconds>(steady_clock::now() - t0).count();
+}
+
+unsigned long millis() { return (unsigned long)(hostMicros() / 1000ULL) + s_offsetMs; }
+unsigned long micros() { return (unsigned long)hostMicros() + s_offsetMs * 1000UL; }
+void delay(unsigned long ms) { s_offsetMs += ms; }
+void yield() {}
+void shimAdvanceMillis(unsigned long ms) { s_offsetMs += ms; }
+
+size_t HardwareSerial::write(uint8_t c) { return write(&c, 1); }
+size_t HardwareSerial::write(const uint8_t* buf, size_t n) {
+  if (!_quiet) fwrite(buf, 1, n, stdout);
+  return n;
+}
+
+static std::mt19937 s_rng(12345);
+uint32_t EspClass::random() const { return (uint32_t)s_rng(); }
+long random(long max) { return max > 0 ? (long)(s_rng() % (unsigned long)max) : 0; }
+long random(long min, long max) { return max > min ? min + random(max - min) : min; }
+void randomSeed(unsigned long s) { s_rng.seed((uint32_t)s); }
+
+void configTime(int, int, const char*, const char*, const char*) {}
+#include <ESP8266WiFi.h>
+ESP8266WiFiClass WiFi;
+#include <Wire.h>
+TwoWire Wire;
+#include <Ticker.h>
+Ticker* Ticker::s_last = nullptr;
@@ -0,0 +1,130 @@
+#pragma once
+// Host-Ersatz für den ESP8266-Arduino-Kern (nur was die Firmware benutzt)
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <algorithm>
+#include "WString.h"
+
+using std::isfinite;
+using std::min;
+using std::max;
+
+// newlib (ESP8266) hat strlcpy, ältere glibc nicht
+#if !defined(__GLIBC__) || !__GLIBC_PREREQ(2, 38)
+inline size_t strlcpy(char* dst, const char* src, size_t size) {
+  const size_t len = strlen(src);
+  if (size) {
+    const size_t n = len < size - 1 ? len : size - 1;
+    memcpy(dst, src, n);
+    dst[n] = '\0';
+  }
+  return len;
+}
+#endif
+
+// --- Zeit ---
+// millis()/micros() laufen auf einer virtuellen Uhr, die Benchmarks vorstellen können.
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void yield();
+void shimAdvanceMillis(unsigned long ms);
+
+// --- Print / Stream ---
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t* buf, size_t n) {
+    size_t w = 0;
+    while (n--) w += write(*buf++);
+    return w;
+  }
+  size_t write(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+  size_t write(const char* s, size_t n) { return write((const uint8_t*)s, n); }
+
+  size_t print(const char* s) { return write(s); }
+  size_t print(const __FlashStringHelper* s) { return write(reinterpret_cast<const char*>(s)); }
+  size_t print(const String& s) { return write(s.c_str(), s.length()); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(int v) { return printf("%d", v); }
+  size_t print(unsigned int v) { return printf("%u", v); }
+  size_t print(long v) { return printf("%ld", v); }
+  size_t print(unsigned long v) { return printf("%lu", v); }
+  size_t print(double v, int d = 2) { return printf("%.*f", d, v); }
+
+  size_t println() { return write("\r\n"); }
+  template <typename T> size_t println(const T& v) { size_t n = print(v); return n + println(); }
+
+  size_t printf(const char* fmt, ...) __attribute__((format(printf, 2, 3))) {
+    char buf[256];
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(buf, sizeof(buf), fmt, ap);
+    va_end(ap);
+    if (n < 0) return 0;
+    return write(buf, std::min((size_t)n, sizeof(buf) - 1));
+  }
+};
+
+class Stream : public Print {
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+  virtual size_t readBytes(char* buf, size_t n) {
+    size_t r = 0;
+    while (r < n) { int c = read(); if (c < 0) break; buf[r++] = (char)c; }
+    return r;
+  }
+  size_t readBytes(uint8_t* buf, size_t n) { return readBytes((char*)buf, n); }
+  String readStringUntil(char term) {
+    String s;
+    int c;
+    while ((c = read()) >= 0 && c != term) s += (char)c;
+    return s;
+  }
+};
+
+class HardwareSerial : public Stream {
+public:
+  void begin(unsigned long) {}
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t* buf, size_t n) override;
+  int available() override { return 0; }
+  int read() override { return -1; }
+  int peek() override { return -1; }
+  void setQuiet(bool q) { _quiet = q; }
+  using Print::write;
+private:
+  bool _quiet = false;
+};
+extern HardwareSerial Serial;
+
+// --- ESP-Systemfunktionen ---
+class EspClass {
+public:
+  uint32_t getChipId() const { return 0x00C0FFEE; }
+  uint32_t getFreeHeap() const { return 40000; }
+  uint32_t getMaxFreeBlockSize() const { return 30000; }
+  uint8_t getHeapFragmentation() const { return 0; }
+  uint32_t getCycleCount() const { return (uint32_t)(micros() * 80UL); }
+  uint8_t getCpuFreqMHz() const { return 80; }
+  uint32_t random() const;
+};
+extern EspClass ESP;
+
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long);
+
+template <typename T> T constrain(T x, T lo, T hi) { return x < lo ? lo : (x > hi ? hi : x); }
+#define ICACHE_RAM_ATTR
+#define IRAM_ATTR
+
+// --- Zeit/NTP ---
+void configTime(int tzOff, int dstOff, const char* s1, const char* s2 = nullptr, const char* s3 = nullptr);
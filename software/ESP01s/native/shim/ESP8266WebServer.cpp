@@ -0,0 +1,120 @@
+#include "ESP8266WebServer.h"
+
+ESP8266WebServer* ESP8266WebServer::s_last = nullptr;
+
+void ESP8266WebServer::serveStatic(const char* uri, FS& fs, const char* path, const char* cacheHeader) {
+  String p = path, c = cacheHeader ? cacheHeader : "";
+  FS* pfs = &fs;
+  on(uri, HTTP_GET, [this, pfs, p, c]() {
+    File f = pfs->open(p, "r");
+    if (!f) { send(404, "text/plain", "not found"); return; }
+    if (c.length()) sendHeader("Cache-Control", c);
+    streamFile(f, "application/octet-stream");
+    f.close();
+  });
+}
+
+void ESP8266WebServer::collectHeaders(const char*[], size_t) {}
+
+bool ESP8266WebServer::hasArg(const String& name) const {
+  for (auto& a : _args) if (a.first == name) return true;
+  return false;
+}
+
+String ESP8266WebServer::arg(const String& name) const {
+  for (auto& a : _args) if (a.first == name) return a.second;
+  return String();
+}
+
+bool ESP8266WebServer::hasHeader(const String& name) const {
+  for (auto& h : _reqHeaders) if (h.first.equalsIgnoreCase(name)) return true;
+  return false;
+}
+
+String ESP8266WebServer::header(const String& name) const {
+  for (auto& h : _reqHeaders) if (h.first.equalsIgnoreCase(name)) return h.second;
+  return String();
+}
+
+void ESP8266WebServer::sendHeader(const String& name, const String& value, bool first) {
+  if (first) _respHeaders.insert(_respHeaders.begin(), {name, value});
+  else _respHeaders.push_back({name, value});
+}
+
+void ESP8266WebServer::writeRaw(const char* data, size_t n) {
+  _client.write((const uint8_t*)data, n);
+  _stats.bytes += n;
+}
+
+void ESP8266WebServer::send(int code, const char* contentType, const String& content) {
+  char line[64];
+  snprintf(line, sizeof(line), "HTTP/1.1 %d\r\n", code);
+  String head = line;
+  if (contentType) head += String("Content-Type: ") + contentType + "\r\n";
+  if (_contentLength == CONTENT_LENGTH_UNKNOWN) {
+    _chunked = true;
+    head += "Transfer-Encoding: chunked\r\n";
+  } else {
+    _chunked = false;
+    size_t len = _contentLength == CONTENT_LENGTH_NOT_SET ? content.length() : _contentLength;
+    head += String("Content-Length: ") + String((unsigned long)len) + "\r\n";
+  }
+  for (auto& h : _respHeaders) head += h.first + ": " + h.second + "\r\n";
+  head += "\r\n";
+  _respHeaders.clear();
+  writeRaw(head.c_str(), head.length());
+  if (content.length()) sendContent(content);
+}
+
+void ESP8266WebServer::sendContent(const char* content, size_t size) {
+  if (_chunked) {
+    char hdr[16];
+    int n = snprintf(hdr, sizeof(hdr), "%zx\r\n", size);
+    writeRaw(hdr, n);
+    if (size) writeRaw(content, size);
+    writeRaw("\r\n", 2);
+    _stats.chunks++;
+    if (size == 0) _chunked = false;
+  } else {
+    writeRaw(content, size);
+  }
+}
+
+size_t ESP8266WebServer::streamFile(File& file, const String& contentType, HTTPMethod) {
+  setContentLength(file.size());
+  String name = file.name();
+  if (name.endsWith(".gz") && contentType != "application/x-gzip" && contentType != "application/octet-stream")
+    sendHeader("Content-Encoding", "gzip");
+  send(200, contentType.c_str(), String());
+  char buf[1460];
+  size_t total = 0, r;
+  while ((r = file.read((uint8_t*)buf, sizeof(buf))) > 0) {
+    writeRaw(buf, r);
+    total += r;
+  }
+  return total;
+}
+
+WiFiClient ESP8266WebServer::shimRequest(HTTPMethod method, const String& uri,
+                                         const std::vector<std::pair<String, String>>& args,
+                                         const std::vector<std::pair<String, String>>& headers) {
+  _stats.requests++;
+  _uri = uri;
+  _method = method;
+  _args = args;
+  _reqHeaders = headers;
+  _respHeaders.clear();
+  _contentLength = CONTENT_LENGTH_NOT_SET;
+  _chunked = false;
+  _client = WiFiClient(std::make_shared<WiFiClient::Context>());
+  _client.context()->keep = _keepOutput;
+
+  for (auto& r : _routes) {
+    if (r.uri == uri && (r.method == HTTP_ANY || r.method == method)) {
+      r.fn();
+      return _client;
+    }
+  }
+  if (_notFound) _notFound();
+  return _client;
+}
@@ -0,0 +1,93 @@
+#pragma once
+// Host-Ersatz für ESP8266WebServer: Requests werden direkt eingespeist (shimRequest),
+// Antworten landen im Sendepuffer des WiFiClient.
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+#include <FS.h>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+enum HTTPMethod { HTTP_ANY, HTTP_GET, HTTP_HEAD, HTTP_POST, HTTP_PUT, HTTP_PATCH, HTTP_DELETE, HTTP_OPTIONS };
+
+#define CONTENT_LENGTH_UNKNOWN ((size_t)-1)
+#define CONTENT_LENGTH_NOT_SET ((size_t)-2)
+
+class ESP8266WebServer {
+public:
+  typedef std::function<void(void)> THandlerFunction;
+
+  struct Stats {
+    unsigned long requests = 0;
+    unsigned long chunks = 0;
+    unsigned long bytes = 0;
+  };
+
+  explicit ESP8266WebServer(int port = 80) : _port(port) { s_last = this; }
+
+  void begin() {}
+  void close() {}
+  void handleClient() {}
+
+  void on(const String& uri, HTTPMethod method, THandlerFunction fn) { _routes.push_back({uri, method, fn}); }
+  void on(const String& uri, THandlerFunction fn) { on(uri, HTTP_ANY, fn); }
+  void onNotFound(THandlerFunction fn) { _notFound = fn; }
+  void serveStatic(const char* uri, FS& fs, const char* path, const char* cacheHeader = nullptr);
+  void collectHeaders(const char* headerKeys[], size_t count);
+
+  // Request-Daten
+  String uri() const { return _uri; }
+  HTTPMethod method() const { return _method; }
+  bool hasArg(const String& name) const;
+  String arg(const String& name) const;
+  String arg(int i) const { return i < (int)_args.size() ? _args[i].second : String(); }
+  String argName(int i) const { return i < (int)_args.size() ? _args[i].first : String(); }
+  int args() const { return (int)_args.size(); }
+  bool hasHeader(const String& name) const;
+  String header(const String& name) const;
+  WiFiClient& client() { return _client; }
+
+  // Antwort
+  void setContentLength(size_t len) { _contentLength = len; }
+  void sendHeader(const String& name, const String& value, bool first = false);
+  void send(int code, const char* contentType = nullptr, const String& content = String());
+  void send(int code, const String& contentType, const String& content) { send(code, contentType.c_str(), content); }
+  void send_P(int code, PGM_P contentType, PGM_P content) { send(code, contentType, String(content)); }
+  void sendContent(const String& content) { sendContent(content.c_str(), content.length()); }
+  void sendContent(const char* content) { sendContent(content, strlen(content)); }
+  void sendContent(const char* content, size_t size);
+  void sendContent_P(PGM_P content) { sendContent(content); }
+  void sendContent_P(PGM_P content, size_t size) { sendContent(content, size); }
+  size_t streamFile(File& file, const String& contentType, HTTPMethod requestMethod = HTTP_GET);
+
+  // Host-spezifisch: Request einspeisen; liefert den Client mit der Antwort
+  WiFiClient shimRequest(HTTPMethod method, const String& uri,
+                         const std::vector<std::pair<String, String>>& args = {},
+                         const std::vector<std::pair<String, String>>& headers = {});
+  Stats& stats() { return _stats; }
+  // false: Antworten nur zählen statt puffern (WiFiClient::Context::sent)
+  void shimKeepOutput(bool keep) { _keepOutput = keep; }
+  // zuletzt konstruierter Server (WebServerMgr hält seinen privat)
+  static ESP8266WebServer* shimLast() { return s_last; }
+
+private:
+  struct Route { String uri; HTTPMethod method; THandlerFunction fn; };
+
+  void writeRaw(const char* data, size_t n);
+
+  int _port;
+  std::vector<Route> _routes;
+  THandlerFunction _notFound;
+  String _uri;
+  HTTPMethod _method = HTTP_GET;
+  std::vector<std::pair<String, String>> _args;
+  std::vector<std::pair<String, String>> _reqHeaders;
+  std::vector<std::pair<String, String>> _respHeaders;
+  WiFiClient _client;
+  size_t _contentLength = CONTENT_LENGTH_NOT_SET;
+  bool _chunked = false;
+  Stats _stats;
+  bool _keepOutput = true;
+  static ESP8266WebServer* s_last;
+};
@@ -0,0 +1,102 @@
+#pragma once
+// Host-Ersatz: WLAN ist auf dem Host immer "verbunden", Clients schreiben in einen Puffer
+#include <Arduino.h>
+#include <memory>
+#include <string>
+
+typedef enum { WL_IDLE_STATUS = 0, WL_CONNECTED = 3, WL_DISCONNECTED = 6 } wl_status_t;
+
+class IPAddress {
+public:
+  IPAddress(uint8_t a = 0, uint8_t b = 0, uint8_t c = 0, uint8_t d = 0) : _b{a, b, c, d} {}
+  uint8_t operator[](int i) const { return _b[i]; }
+  uint8_t& operator[](int i) { return _b[i]; }
+  String toString() const {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%u.%u.%u.%u", _b[0], _b[1], _b[2], _b[3]);
+    return String(buf);
+  }
+  bool fromString(const char* s) {
+    unsigned a, b, c, d;
+    if (sscanf(s, "%u.%u.%u.%u", &a, &b, &c, &d) != 4) return false;
+    _b[0] = a; _b[1] = b; _b[2] = c; _b[3] = d;
+    return true;
+  }
+  explicit operator bool() const { return _b[0] | _b[1] | _b[2] | _b[3]; }
+private:
+  uint8_t _b[4];
+};
+
+class Client : public Stream {
+public:
+  virtual int connect(IPAddress ip, uint16_t port) = 0;
+  virtual int connect(const char* host, uint16_t port) = 0;
+  virtual uint8_t connected() = 0;
+  virtual void stop() = 0;
+  virtual explicit operator bool() = 0;
+};
+
+// Client-Verbindung; alle Kopien teilen sich Sendepuffer und Zustand (wie ClientContext)
+class WiFiClient : public Client {
+public:
+  struct Context {
+    std::string tx;           // vom Gerät gesendete Bytes (nur wenn keep)
+    size_t sent = 0;          // Anzahl gesendeter Bytes
+    bool keep = true;         // false: nur zählen (Benchmarks, kein Heap für den Puffer)
+    std::string rx;           // eingehende Bytes
+    size_t rxPos = 0;
+    bool open = true;
+    size_t window = (size_t)-1;  // Sendefenster (für Tests mit langsamem Client)
+  };
+
+  WiFiClient() {}
+  explicit WiFiClient(std::shared_ptr<Context> ctx) : _ctx(std::move(ctx)) {}
+
+  int connect(IPAddress, uint16_t) override { _ctx = std::make_shared<Context>(); return 1; }
+  int connect(const char*, uint16_t) override { _ctx = std::make_shared<Context>(); return 1; }
+  uint8_t connected() override { return _ctx && _ctx->open; }
+  void stop() override { if (_ctx) _ctx->open = false; }
+  explicit operator bool() override { return connected(); }
+  void setTimeout(unsigned long) {}
+  void setNoDelay(bool) {}
+
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t* buf, size_t n) override {
+    if (!connected()) return 0;
+    n = std::min(n, _ctx->window);
+    if (_ctx->keep) _ctx->tx.append((const char*)buf, n);
+    _ctx->sent += n;
+    return n;
+  }
+  using Print::write;
+  size_t availableForWrite() { return connected() ? std::min<size_t>(_ctx->window, 1460) : 0; }
+  int available() override { return _ctx ? (int)(_ctx->rx.size() - _ctx->rxPos) : 0; }
+  int read() override { return available() ? (uint8_t)_ctx->rx[_ctx->rxPos++] : -1; }
+  int peek() override { return available() ? (uint8_t)_ctx->rx[_ctx->rxPos] : -1; }
+  IPAddress remoteIP() const { return IPAddress(127, 0, 0, 1); }
+
+  Context* context() const { return _ctx.get(); }
+
+private:
+  std::shared_ptr<Context> _ctx;
+};
+
+class WiFiUDP {
+public:
+  uint8_t begin(uint16_t) { return 1; }
+  int beginPacket(IPAddress, uint16_t) { return 1; }
+  size_t write(const uint8_t*, size_t n) { return n; }
+  int endPacket() { return 1; }
+  void stop() {}
+};
+
+class ESP8266WiFiClass {
+public:
+  wl_status_t status() const { return WL_CONNECTED; }
+  IPAddress localIP() const { return IPAddress(127, 0, 0, 1); }
+  IPAddress gatewayIP() const { return IPAddress(127, 0, 0, 1); }
+  int32_t RSSI() const { return -50; }
+  String macAddress() const { return String("00:00:00:00:00:00"); }
+  int hostByName(const char*, IPAddress& out) { out = IPAddress(127, 0, 0, 1); return 1; }
+};
+extern ESP8266WiFiClass WiFi;
@@ -0,0 +1,232 @@
+#include "FS.h"
+#include "LittleFS.h"
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+
+FS LittleFS;
+ShimFsStats shimFsStats;
+
+struct File::Handle {
+  FILE* fp = nullptr;
+  std::string path;     // FS-Pfad, z.B. "/logs/log_0000.bin"
+  std::string base;     // Dateiname ohne Verzeichnis
+  ~Handle() { if (fp) { fclose(fp); shimFsStats.closes++; } }
+};
+
+File::File(FILE* fp, const std::string& path) : _h(std::make_shared<Handle>()) {
+  _h->fp = fp;
+  _h->path = path;
+  size_t slash = path.rfind('/');
+  _h->base = (slash == std::string::npos) ? path : path.substr(slash + 1);
+}
+
+size_t File::write(const uint8_t* buf, size_t n) {
+  if (!_h) return 0;
+  shimFsStats.writes++;
+  size_t w = fwrite(buf, 1, LittleFS.writable(n, _h->fp), _h->fp);
+  shimFsStats.bytesWritten += w;
+  return w;
+}
+
+int File::available() {
+  if (!_h) return 0;
+  long pos = ftell(_h->fp);
+  return (int)(size() - (size_t)pos);
+}
+
+int File::read() {
+  uint8_t c;
+  return read(&c, 1) == 1 ? c : -1;
+}
+
+int File::peek() {
+  if (!_h) return -1;
+  int c = fgetc(_h->fp);
+  if (c != EOF) ungetc(c, _h->fp);
+  return c == EOF ? -1 : c;
+}
+
+size_t File::read(uint8_t* buf, size_t n) {
+  if (!_h) return 0;
+  shimFsStats.reads++;
+  size_t r = fread(buf, 1, n, _h->fp);
+  shimFsStats.bytesRead += r;
+  return r;
+}
+
+bool File::seek(uint32_t pos, SeekMode mode) {
+  if (!_h) return false;
+  int whence = mode == SeekCur ? SEEK_CUR : (mode == SeekEnd ? SEEK_END : SEEK_SET);
+  return fseek(_h->fp, (long)pos, whence) == 0;
+}
+
+size_t File::position() const { return _h ? (size_t)ftell(_h->fp) : 0; }
+
+size_t File::size() const {
+  if (!_h) return 0;
+  fflush(_h->fp);
+  struct stat st;
+  if (fstat(fileno(_h->fp), &st) != 0) return 0;
+  return (size_t)st.st_size;
+}
+
+bool File::truncate(uint32_t size) {
+  if (!_h || LittleFS.failTruncate()) return false;
+  fflush(_h->fp);
+  return ftruncate(fileno(_h->fp), size) == 0;
+}
+
+void File::flush() { if (_h) fflush(_h->fp); }
+void File::close() { _h.reset(); }
+const char* File::name() const { return _h ? _h->base.c_str() : ""; }
+const char* File::fullName() const { return _h ? _h->path.c_str() : ""; }
+
+Dir::Dir(const std::string& path) : _path(path) {
+  shimFsStats.dirScans++;
+  DIR* d = opendir(LittleFS.hostPath(path.c_str()).c_str());
+  if (!d) return;
+  while (struct dirent* e = readdir(d)) {
+    std::string n = e->d_name;
+    if (n == "." || n == "..") continue;
+    _names.push_back(n);
+  }
+  closedir(d);
+  // LittleFS liefert keine garantierte Reihenfolge; Host sortiert nicht
+}
+
+bool Dir::next() {
+  if (!_started) { _started = true; _pos = 0; }
+  else _pos++;
+  return _pos < _names.size();
+}
+
+String Dir::fileName() const { return _pos < _names.size() ? String(_names[_pos]) : String(); }
+
+size_t Dir::fileSize() const {
+  struct stat st;
+  std::string p = LittleFS.hostPath((_path + "/" + _names[_pos]).c_str());
+  return stat(p.c_str(), &st) == 0 ? (size_t)st.st_size : 0;
+}
+
+bool Dir::isFile() const { return !isDirectory(); }
+
+bool Dir::isDirectory() const {
+  struct stat st;
+  std::string p = LittleFS.hostPath((_path + "/" + _names[_pos]).c_str());
+  return stat(p.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+File Dir::openFile(const char* mode) const {
+  return LittleFS.open((_path + "/" + _names[_pos]).c_str(), mode);
+}
+
+std::string FS::hostPath(const char* path) const {
+  std::string p = path ? path : "";
+  if (p.empty() || p[0] != '/') p = "/" + p;
+  return _root + p;
+}
+
+bool FS::begin() {
+  // Wurzel samt fehlender Elternverzeichnisse anlegen
+  for (size_t p = _root.find('/', 1); p != std::string::npos; p = _root.find('/', p + 1)) {
+    ::mkdir(_root.substr(0, p).c_str(), 0755);
+  }
+  ::mkdir(_root.c_str(), 0755);
+  struct stat st;
+  return stat(_root.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+static void removeTree(const std::string& host) {
+  DIR* d = opendir(host.c_str());
+  if (!d) { ::remove(host.c_str()); return; }
+  while (struct dirent* e = readdir(d)) {
+    std::string n = e->d_name;
+    if (n == "." || n == "..") continue;
+    removeTree(host + "/" + n);
+  }
+  closedir(d);
+  ::rmdir(host.c_str());
+}
+
+bool FS::format() {
+  removeTree(_root);
+  return begin();
+}
+
+static size_t usedBytes(const std::string& host, bool blocks = true) {
+  size_t sum = 0;
+  DIR* d = opendir(host.c_str());
+  if (!d) return 0;
+  while (struct dirent* e = readdir(d)) {
+    std::string n = e->d_name;
+    if (n == "." || n == "..") continue;
+    std::string p = host + "/" + n;
+    struct stat st;
+    if (stat(p.c_str(), &st) != 0) continue;
+    if (S_ISDIR(st.st_mode)) sum += usedBytes(p, blocks);
+    else if (blocks) sum += ((size_t)st.st_size + 4095) / 4096 * 4096; // ganze Blöcke wie LittleFS
+    else sum += (size_t)st.st_size;
+  }
+  closedir(d);
+  return sum;
+}
+
+bool FS::info(FSInfo& info) {
+  info.totalBytes = _total;
+  info.usedBytes = std::min(_total, usedBytes(_root) + 2 * 4096);
+  info.blockSize = 4096;
+  info.pageSize = 256;
+  info.maxOpenFiles = 5;
+  info.maxPathLength = 32;
+  return true;
+}
+
+size_t FS::writable(size_t n, FILE* fp) const {
+  if (!_enforce) return n;
+  fflush(fp); // eigene gepufferte Daten mitzählen
+  const size_t used = usedBytes(_root, false);
+  return used >= _total ? 0 : std::min(n, _total - used);
+}
+
+File FS::open(const char* path, const char* mode) {
+  std::string m = mode;
+  const char* hm = "rb";
+  if (m == "r") hm = "rb";
+  else if (m == "r+") hm = "r+b";
+  else if (m == "w") hm = "wb";
+  else if (m == "w+") hm = "w+b";
+  else if (m == "a") hm = "ab";
+  else if (m == "a+") hm = "a+b";
+  FILE* fp = fopen(hostPath(path).c_str(), hm);
+  if (!fp) return File();
+  shimFsStats.opens++;
+  std::string p = path;
+  if (p.empty() || p[0] != '/') p = "/" + p;
+  return File(fp, p);
+}
+
+bool FS::exists(const char* path) {
+  struct stat st;
+  return stat(hostPath(path).c_str(), &st) == 0;
+}
+
+Dir FS::openDir(const char* path) { return Dir(path); }
+
+bool FS::rename(const char* from, const char* to) {
+  return ::rename(hostPath(from).c_str(), hostPath(to).c_str()) == 0;
+}
+
+bool FS::remove(const char* path) {
+  shimFsStats.removes++;
+  return ::remove(hostPath(path).c_str()) == 0;
+}
+
+bool FS::mkdir(const char* path) {
+  return ::mkdir(hostPath(path).c_str(), 0755) == 0;
+}
+
+bool FS::rmdir(const char* path) {
+  return ::rmdir(hostPath(path).c_str()) == 0;
+}
@@ -0,0 +1,120 @@
+#pragma once
+// Host-Ersatz für das ESP8266-FS-API, abgebildet auf ein Verzeichnis des Hosts
+#include <Arduino.h>
+#include <stdio.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+enum SeekMode { SeekSet = 0, SeekCur = 1, SeekEnd = 2 };
+
+struct FSInfo {
+  size_t totalBytes;
+  size_t usedBytes;
+  size_t blockSize;
+  size_t pageSize;
+  size_t maxOpenFiles;
+  size_t maxPathLength;
+};
+
+// Zähler der FS-Zugriffe (für Benchmarks)
+struct ShimFsStats {
+  unsigned long opens = 0;
+  unsigned long closes = 0;
+  unsigned long reads = 0;
+  unsigned long writes = 0;
+  unsigned long bytesRead = 0;
+  unsigned long bytesWritten = 0;
+  unsigned long dirScans = 0;
+  unsigned long removes = 0;
+};
+extern ShimFsStats shimFsStats;
+
+class File : public Stream {
+public:
+  File() {}
+  File(FILE* fp, const std::string& path);
+
+  explicit operator bool() const { return (bool)_h; }
+
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t* buf, size_t n) override;
+  using Print::write;
+  int available() override;
+  int read() override;
+  int peek() override;
+  size_t read(uint8_t* buf, size_t n);
+  size_t readBytes(char* buf, size_t n) override { return read((uint8_t*)buf, n); }
+  bool seek(uint32_t pos, SeekMode mode = SeekSet);
+  size_t position() const;
+  size_t size() const;
+  bool truncate(uint32_t size);
+  void flush();
+  void close();
+  const char* name() const;
+  const char* fullName() const;
+  bool isFile() const { return (bool)_h; }
+
+private:
+  struct Handle;
+  std::shared_ptr<Handle> _h;
+};
+
+class Dir {
+public:
+  Dir() {}
+  Dir(const std::string& path);
+  bool next();
+  String fileName() const;
+  size_t fileSize() const;
+  bool isFile() const;
+  bool isDirectory() const;
+  File openFile(const char* mode) const;
+
+private:
+  std::string _path;
+  std::vector<std::string> _names;
+  size_t _pos = 0;
+  bool _started = false;
+};
+
+class FS {
+public:
+  bool begin();
+  void end() {}
+  bool format();
+  bool info(FSInfo& info);
+  File open(const char* path, const char* mode);
+  File open(const String& path, const char* mode) { return open(path.c_str(), mode); }
+  bool exists(const char* path);
+  bool exists(const String& path) { return exists(path.c_str()); }
+  Dir openDir(const char* path);
+  Dir openDir(const String& path) { return openDir(path.c_str()); }
+  bool rename(const char* from, const char* to);
+  bool rename(const String& from, const String& to) { return rename(from.c_str(), to.c_str()); }
+  bool remove(const char* path);
+  bool remove(const String& path) { return remove(path.c_str()); }
+  bool mkdir(const char* path);
+  bool mkdir(const String& path) { return mkdir(path.c_str()); }
+  bool rmdir(const char* path);
+  bool rmdir(const String& path) { return rmdir(path.c_str()); }
+
+  // Host-spezifisch: Wurzelverzeichnis und simulierte Flash-Größe
+  void setRoot(const std::string& root) { _root = root; }
+  void setTotalBytes(size_t n) { _total = n; }
+  // Schreiben endet kurz, sobald die Dateien totalBytes belegen (wie LittleFS
+  // bei vollem Flash); Standard aus, da jede Schreiboperation den Baum summiert
+  void setEnforceSize(bool on) { _enforce = on; }
+  size_t writable(size_t n, FILE* fp) const;
+  // File::truncate() schlägt fehl (Fehlerpfad der Schreiber testen)
+  void setFailTruncate(bool on) { _failTruncate = on; }
+  bool failTruncate() const { return _failTruncate; }
+  std::string hostPath(const char* path) const;
+
+private:
+  std::string _root = ".fsroot";
+  size_t _total = 1024 * 1024;
+  bool _enforce = false;
+  bool _failTruncate = false;
+};
+
@@ -0,0 +1,43 @@
+#pragma once
+// Host-Ersatz für PubSubClient: keine Verbindung nach außen, publish() wird nur gezählt
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+#include <functional>
+#define MQTT_CONNECTED 0
+#define MQTT_CONNECTION_TIMEOUT -4
+#define MQTT_DISCONNECTED -1
+class PubSubClient {
+public:
+  PubSubClient() {}
+  PubSubClient(Client& c) : _c(&c) {}
+  PubSubClient& setServer(const char*, uint16_t) { return *this; }
+  PubSubClient& setServer(IPAddress, uint16_t) { return *this; }
+  PubSubClient& setClient(Client& c) { _c = &c; return *this; }
+  PubSubClient& setCallback(std::function<void(char*, uint8_t*, unsigned int)>) { return *this; }
+  bool setBufferSize(uint16_t n) { _buf = n; return true; }
+  uint16_t getBufferSize() { return _buf; }
+  PubSubClient& setSocketTimeout(uint16_t) { return *this; }
+  PubSubClient& setKeepAlive(uint16_t) { return *this; }
+  bool connect(const char*) { return _conn = true; }
+  bool connect(const char*, const char*, const char*) { return _conn = true; }
+  bool connect(const char*, const char*, const char*, const char*, uint8_t, bool, const char*) { return _conn = true; }
+  bool connect(const char*, const char*, const char*, const char*, uint8_t, bool, const char*, bool) { return _conn = true; }
+  void disconnect() { _conn = false; }
+  bool publish(const char* t, const char* p) { return publish(t, p, false); }
+  bool publish(const char* t, const char* p, bool r) { published++; lastTopic = t; lastPayload = p; (void)r; return _conn; }
+  bool publish(const char* t, const uint8_t* p, unsigned int n, bool r) { published++; lastTopic = t; lastPayload = String(std::string((const char*)p, n)); (void)r; return _conn; }
+  bool beginPublish(const char* t, unsigned int, bool) { lastTopic = t; lastPayload = String(); return _conn; }
+  size_t write(const uint8_t* b, size_t n) { lastPayload += String(std::string((const char*)b, n)); return n; }
+  size_t write(uint8_t c) { lastPayload += (char)c; return 1; }
+  int endPublish() { published++; return 1; }
+  bool subscribe(const char*) { return true; }
+  bool loop() { return _conn; }
+  bool connected() { return _conn; }
+  int state() { return _conn ? 0 : -1; }
+  unsigned long published = 0;
+  String lastTopic, lastPayload;
+private:
+  Client* _c = nullptr;
+  bool _conn = false;
+  uint16_t _buf = 256;
+};
@@ -0,0 +1,27 @@
+#pragma once
+// Host-Ersatz für Ticker: merkt sich nur den Rückruf; Tests lösen ihn mit shimFire() aus
+#include <Arduino.h>
+#include <functional>
+
+class Ticker {
+public:
+  template <typename TArg>
+  void attach_ms(uint32_t ms, void (*callback)(TArg), TArg arg) {
+    _ms = ms;
+    _fn = [callback, arg]() { callback(arg); };
+    s_last = this;
+  }
+  void attach_ms(uint32_t ms, std::function<void(void)> fn) { _ms = ms; _fn = fn; s_last = this; }
+  void detach() { _fn = nullptr; }
+  bool active() const { return (bool)_fn; }
+
+  void shimFire() { if (_fn) _fn(); }
+  uint32_t shimPeriod() const { return _ms; }
+  // zuletzt gestarteter Ticker (z.B. der private im SensorINA219)
+  static Ticker* shimLast() { return s_last; }
+
+private:
+  uint32_t _ms = 0;
+  std::function<void(void)> _fn;
+  static Ticker* s_last;
+};
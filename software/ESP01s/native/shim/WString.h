@@ -0,0 +1,97 @@
+#pragma once
+// Minimaler Host-Ersatz für Arduino-String (nur benutzte Methoden)
+#include <string>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <cctype>
+
+class __FlashStringHelper;
+#define F(s) (reinterpret_cast<const __FlashStringHelper*>(s))
+#define PSTR(s) (s)
+#define PGM_P const char*
+#define PROGMEM
+
+class String {
+public:
+  String() {}
+  String(const char* s) : _s(s ? s : "") {}
+  String(const __FlashStringHelper* s) : _s(reinterpret_cast<const char*>(s)) {}
+  String(const std::string& s) : _s(s) {}
+  String(char c) : _s(1, c) {}
+  String(int v)                { char b[16]; snprintf(b, sizeof(b), "%d", v); _s = b; }
+  String(unsigned int v)       { char b[16]; snprintf(b, sizeof(b), "%u", v); _s = b; }
+  String(long v)               { char b[24]; snprintf(b, sizeof(b), "%ld", v); _s = b; }
+  String(unsigned long v)      { char b[24]; snprintf(b, sizeof(b), "%lu", v); _s = b; }
+  String(long long v)          { char b[24]; snprintf(b, sizeof(b), "%lld", v); _s = b; }
+  String(unsigned long long v) { char b[24]; snprintf(b, sizeof(b), "%llu", v); _s = b; }
+  String(float v, unsigned char d = 2)  { char b[32]; snprintf(b, sizeof(b), "%.*f", d, (double)v); _s = b; }
+  String(double v, unsigned char d = 2) { char b[32]; snprintf(b, sizeof(b), "%.*f", d, v); _s = b; }
+
+  unsigned int length() const { return (unsigned int)_s.size(); }
+  const char* c_str() const { return _s.c_str(); }
+  bool reserve(unsigned int n) { _s.reserve(n); return true; }
+  bool isEmpty() const { return _s.empty(); }
+
+  char operator[](unsigned int i) const { return i < _s.size() ? _s[i] : 0; }
+  char& operator[](unsigned int i) { return _s[i]; }
+  char charAt(unsigned int i) const { return (*this)[i]; }
+
+  bool startsWith(const String& p) const { return _s.compare(0, p._s.size(), p._s) == 0; }
+  bool endsWith(const String& p) const {
+    return _s.size() >= p._s.size() && _s.compare(_s.size() - p._s.size(), p._s.size(), p._s) == 0;
+  }
+  bool equals(const String& o) const { return _s == o._s; }
+  bool equalsIgnoreCase(const String& o) const {
+    if (_s.size() != o._s.size()) return false;
+    for (size_t i = 0; i < _s.size(); ++i)
+      if (tolower((unsigned char)_s[i]) != tolower((unsigned char)o._s[i])) return false;
+    return true;
+  }
+
+  int indexOf(char c, unsigned int from = 0) const { auto p = _s.find(c, from); return p == std::string::npos ? -1 : (int)p; }
+  int indexOf(const String& s, unsigned int from = 0) const { auto p = _s.find(s._s, from); return p == std::string::npos ? -1 : (int)p; }
+  int lastIndexOf(char c) const { auto p = _s.rfind(c); return p == std::string::npos ? -1 : (int)p; }
+
+  String substring(unsigned int from) const { return from >= _s.size() ? String() : String(_s.substr(from)); }
+  String substring(unsigned int from, unsigned int to) const {
+    if (from > to) std::swap(from, to);
+    if (from >= _s.size()) return String();
+    return String(_s.substr(from, to - from));
+  }
+  void remove(unsigned int idx) { if (idx < _s.size()) _s.erase(idx); }
+  void remove(unsigned int idx, unsigned int n) { if (idx < _s.size()) _s.erase(idx, n); }
+  void trim() {
+    size_t a = _s.find_first_not_of(" \t\r\n");
+    size_t b = _s.find_last_not_of(" \t\r\n");
+    _s = (a == std::string::npos) ? std::string() : _s.substr(a, b - a + 1);
+  }
+  void replace(const String& from, const String& to) {
+    if (from._s.empty()) return;
+    size_t p = 0;
+    while ((p = _s.find(from._s, p)) != std::string::npos) { _s.replace(p, from._s.size(), to._s); p += to._s.size(); }
+  }
+
+  long toInt() const { return strtol(_s.c_str(), nullptr, 10); }
+  float toFloat() const { return strtof(_s.c_str(), nullptr); }
+
+  bool concat(const String& o) { _s += o._s; return true; }
+  bool concat(const char* s, unsigned int n) { _s.append(s, n); return true; }
+  String& operator+=(const String& o) { _s += o._s; return *this; }
+  String& operator+=(const char* o) { _s += o; return *this; }
+  String& operator+=(char c) { _s += c; return *this; }
+
+  friend String operator+(const String& a, const String& b) { return String(a._s + b._s); }
+  friend String operator+(const String& a, const char* b) { return String(a._s + b); }
+  friend String operator+(const char* a, const String& b) { return String(a + b._s); }
+  friend String operator+(const String& a, char b) { return String(a._s + b); }
+
+  bool operator==(const String& o) const { return _s == o._s; }
+  bool operator!=(const String& o) const { return _s != o._s; }
+  bool operator==(const char* o) const { return _s == o; }
+  bool operator!=(const char* o) const { return _s != o; }
+  bool operator<(const String& o) const { return _s < o._s; }
+
+private:
+  std::string _s;
+};
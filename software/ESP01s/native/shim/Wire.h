@@ -0,0 +1,27 @@
+#pragma once
+// Host-Ersatz für TwoWire mit simulierten INA219-Registern (regs[]: Registerzeiger + 16-Bit-Werte)
+#include <Arduino.h>
+class TwoWire {
+public:
+  void begin(int, int) {}
+  void setClock(uint32_t) {}
+  void beginTransmission(uint8_t a) { _addr = a; _n = 0; }
+  size_t write(uint8_t b) { if (_n < sizeof(_tx)) _tx[_n++] = b; return 1; }
+  uint8_t endTransmission(bool = true);
+  uint8_t requestFrom(uint8_t a, uint8_t n);
+  int read() { return _pos < _rxn ? _rx[_pos++] : -1; }
+  int available() { return _rxn - _pos; }
+  uint16_t regs[8] = {0};
+  uint8_t ptr = 0;
+private:
+  uint8_t _addr = 0, _tx[8], _n = 0, _rx[8], _rxn = 0, _pos = 0;
+};
+inline uint8_t TwoWire::endTransmission(bool) {
+  if (_n >= 1) ptr = _tx[0] & 7;
+  if (_n >= 3) regs[ptr] = (uint16_t)(_tx[1] << 8 | _tx[2]);
+  return 0;
+}
+inline uint8_t TwoWire::requestFrom(uint8_t, uint8_t n) {
+  _rx[0] = regs[ptr] >> 8; _rx[1] = regs[ptr] & 0xFF; _rxn = n > 2 ? 2 : n; _pos = 0; return _rxn;
+}
+extern TwoWire Wire;
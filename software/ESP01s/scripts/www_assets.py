@@ -0,0 +1,85 @@
+# Baut das Dateisystem-Abbild aus data/ nach .pio/data/ und ersetzt dabei
+# data/www durch gzip-Kopien plus Manifest (www/assets.json):
+#
+#   - Verweise in den HTML-Seiten auf CSS/JS bekommen "?v=<hash>", damit der
+#     Browser diese Dateien dauerhaft cachen darf (Cache-Control immutable)
+#   - jede Datei wird als <name>.gz abgelegt (feste mtime -> reproduzierbar)
+#   - assets.json: uri, Datei, ETag (Hash der .gz) und Content-Type je Asset
+#
+# WebServerMgr lädt das Manifest beim Start und beantwortet If-None-Match
+# ohne Flash-Zugriff mit 304.
+Import("env")
+
+import gzip
+import hashlib
+import json
+import os
+import re
+import shutil
+
+MIME = {
+    ".html": "text/html",
+    ".css": "text/css",
+    ".js": "application/javascript",
+    ".json": "application/json",
+    ".svg": "image/svg+xml",
+    ".png": "image/png",
+    ".ico": "image/x-icon",
+}
+
+project = env.subst("$PROJECT_DIR")
+src_dir = os.path.join(project, "data")
+out_dir = os.path.join(project, ".pio", "data")
+
+
+def short_hash(data):
+    return hashlib.sha1(data).hexdigest()[:16]
+
+
+def build():
+    shutil.rmtree(out_dir, ignore_errors=True)
+    shutil.copytree(src_dir, out_dir, ignore=shutil.ignore_patterns("www"))
+
+    www_src = os.path.join(src_dir, "www")
+    www_out = os.path.join(out_dir, "www")
+    os.makedirs(www_out)
+
+    files = {}
+    for name in sorted(os.listdir(www_src)):
+        with open(os.path.join(www_src, name), "rb") as f:
+            files[name] = f.read()
+
+    # Versionsparameter für alles außer HTML (die Seiten selbst werden revalidiert)
+    versions = {n: short_hash(d) for n, d in files.items() if not n.endswith(".html")}
+
+    def versioned(m):
+        name = m.group(2)
+        return m.group(1) + "/" + name + "?v=" + versions[name] + m.group(3)
+
+    ref = re.compile(r'((?:src|href)=")/(' + "|".join(re.escape(n) for n in versions) + r')(")')
+
+    assets = []
+    total_in = total_out = 0
+    for name, data in files.items():
+        if name.endswith(".html") and versions:
+            data = ref.sub(versioned, data.decode("utf-8")).encode("utf-8")
+        gz = gzip.compress(data, compresslevel=9, mtime=0)
+        with open(os.path.join(www_out, name + ".gz"), "wb") as f:
+            f.write(gz)
+        assets.append({
+            "uri": "/" + name,
+            "file": "/www/" + name + ".gz",
+            "etag": short_hash(gz),
+            "type": MIME.get(os.path.splitext(name)[1], "application/octet-stream"),
+        })
+        total_in += len(data)
+        total_out += len(gz)
+
+    with open(os.path.join(www_out, "assets.json"), "w") as f:
+        json.dump({"assets": assets}, f, separators=(",", ":"))
+
+    print("www_assets: %d Dateien, %d -> %d Byte (gzip)" % (len(assets), total_in, total_out))
+
+
+build()
+env.Replace(PROJECT_DATA_DIR=out_dir)
@@ -1,166 +1,433 @@
 #include "DataLogger.h"
 
-static String joinPath(const String& dir, const String& file) {
-  if (dir.endsWith("/")) return dir + file;
-  return dir + "/" + file;
+// ---- LogAggregate ----
+
+static int16_t toDeciWatt(int32_t mW) {
+  // mW -> 10 mW, gerundet und auf int16 begrenzt (±327 W)
+  const int32_t v = (mW >= 0 ? mW + 5 : mW - 5) / 10;
+  return (int16_t)constrain(v, (int32_t)-32768, (int32_t)32767);
 }
 
-bool DataLogger::ensureDir() const {
-  if (LittleFS.exists(_dir)) return true;
-  return LittleFS.mkdir(_dir);
+static int32_t roundDiv(int64_t sum, uint32_t n) {
+  return (int32_t)((sum >= 0 ? sum + n / 2 : sum - (int64_t)(n / 2)) / (int64_t)n);
 }
 
-bool DataLogger::parseIndex(const String& name, const String& prefix, const String& ext, int& out) {
-  if (!name.startsWith(prefix) || !name.endsWith(ext)) return false;
-  const int start = prefix.length();
-  const int end   = name.length() - ext.length(); // ext ist bereits String
-  if (end - start != 4) return false;             // genau 4 Ziffern
-  for (int i = start; i < end; ++i) {
-    if (name[i] < '0' || name[i] > '9') return false;
+void LogAggregate::add(const LogRecord& r) {
+  const int32_t p = (int32_t)r.bus_mV * r.curr_mA / 1000;
+  if (n == 0) {
+    vMin = vMax = r.bus_mV;
+    iMin = iMax = r.curr_mA;
+    pMin = pMax = p;
+    vSum = iSum = pSum = 0;
+  } else {
+    if (r.bus_mV < vMin) vMin = r.bus_mV;
+    if (r.bus_mV > vMax) vMax = r.bus_mV;
+    if (r.curr_mA < iMin) iMin = r.curr_mA;
+    if (r.curr_mA > iMax) iMax = r.curr_mA;
+    if (p < pMin) pMin = p;
+    if (p > pMax) pMax = p;
   }
-  out = name.substring(start, end).toInt();
-  return true;
+  vSum += r.bus_mV;
+  iSum += r.curr_mA;
+  pSum += p;
+  n++;
 }
 
-String DataLogger::makeName(const String& prefix, int index, const String& ext) {
-  char buf[16];
-  snprintf(buf, sizeof(buf), "%04d", index & 0xFFFF);
-  return prefix + String(buf) + ext;
+void LogAggregate::add(const RollupRecord& r) {
+  if (r.n == 0) return;
+  LogAggregate a;
+  a.n = r.n;
+  a.vMin = r.vMin; a.vMax = r.vMax;
+  a.iMin = r.iMin; a.iMax = r.iMax;
+  a.pMin = (int32_t)r.pMin * 10; a.pMax = (int32_t)r.pMax * 10;
+  a.vSum = (int64_t)r.vAvg * r.n;
+  a.iSum = (int64_t)r.iAvg * r.n;
+  a.pSum = (int64_t)r.pAvg * 10 * r.n;
+  add(a);
 }
 
-void DataLogger::scanExisting(int& minIdx, int& maxIdx, size_t& count) const {
-  minIdx =  0x7FFFFFFF;
-  maxIdx = -0x7FFFFFFF;
-  count  = 0;
+void LogAggregate::add(const LogAggregate& a) {
+  if (a.n == 0) return;
+  if (n == 0) {
+    vMin = a.vMin; vMax = a.vMax;
+    iMin = a.iMin; iMax = a.iMax;
+    pMin = a.pMin; pMax = a.pMax;
+    vSum = iSum = pSum = 0;
+  } else {
+    if (a.vMin < vMin) vMin = a.vMin;
+    if (a.vMax > vMax) vMax = a.vMax;
+    if (a.iMin < iMin) iMin = a.iMin;
+    if (a.iMax > iMax) iMax = a.iMax;
+    if (a.pMin < pMin) pMin = a.pMin;
+    if (a.pMax > pMax) pMax = a.pMax;
+  }
+  vSum += a.vSum;
+  iSum += a.iSum;
+  pSum += a.pSum;
+  n += a.n;
+}
 
-  Dir dir = LittleFS.openDir(_dir);
-  while (dir.next()) {
-    String fname = dir.fileName();
-    int idx;
-    if (parseIndex(fname, _prefix, _ext, idx)) {
-      count++;
-      if (idx < minIdx) minIdx = idx;
-      if (idx > maxIdx) maxIdx = idx;
+void LogAggregate::widen(const Measurement& m) {
+  if (n == 0 || m.samples == 0) return;
+  const long vLo = lroundf(m.busMinV * 1000.0f), vHi = lroundf(m.busMaxV * 1000.0f);
+  const long iLo = lroundf(m.currMinmA), iHi = lroundf(m.currMaxmA);
+  vMin = min(vMin, (uint16_t)constrain(vLo, 0L, 65535L));
+  vMax = max(vMax, (uint16_t)constrain(vHi, 0L, 65535L));
+  iMin = min(iMin, (int16_t)constrain(iLo, -32768L, 32767L));
+  iMax = max(iMax, (int16_t)constrain(iHi, -32768L, 32767L));
+  pMin = min(pMin, (int32_t)lroundf(m.powerMinmW));
+  pMax = max(pMax, (int32_t)lroundf(m.powerMaxmW));
+}
+
+void LogAggregate::toRecord(RollupRecord& out) const {
+  out.epoch = t;
+  out.n     = (uint16_t)min(n, (uint32_t)65535);
+  out.vMin  = vMin;
+  out.vMax  = vMax;
+  out.vAvg  = n ? (uint16_t)roundDiv(vSum, n) : 0;
+  out.iMin  = iMin;
+  out.iMax  = iMax;
+  out.iAvg  = n ? (int16_t)roundDiv(iSum, n) : 0;
+  out.pMin  = toDeciWatt(pMin);
+  out.pMax  = toDeciWatt(pMax);
+  out.pAvg  = n ? toDeciWatt(roundDiv(pSum, n)) : 0;
+}
+
+size_t LogAggregate::formatCSV(char* out, size_t cap) const {
+  if (n == 0) return 0;
+  const int n2 = snprintf(out, cap, "%lu;%lu;%u;%u;%ld;%d;%d;%ld;%ld;%ld;%ld\n",
+                          (unsigned long)t, (unsigned long)n,
+                          (unsigned)vMin, (unsigned)vMax, (long)roundDiv(vSum, n),
+                          (int)iMin, (int)iMax, (long)roundDiv(iSum, n),
+                          (long)pMin, (long)pMax, (long)roundDiv(pSum, n));
+  return (n2 > 0 && (size_t)n2 < cap) ? (size_t)n2 : 0;
+}
+
+// ---- LogStats ----
+
+void LogStats::Series::add(int32_t x, uint32_t epoch, uint32_t n) {
+  if (n == 1) {
+    min = max = x;
+    minAt = maxAt = epoch;
+  } else {
+    // bei gleichen Werten gilt der erste Zeitpunkt
+    if (x < min) { min = x; minAt = epoch; }
+    if (x > max) { max = x; maxAt = epoch; }
+  }
+  const double d = x - mean;
+  mean += d / n;
+  m2 += d * (x - mean);
+}
+
+void LogStats::Series::toJson(JsonObject o, uint32_t n) const {
+  o["avg"]   = round(mean * 10) / 10;
+  o["sd"]    = n > 1 ? round(sqrt(m2 / (n - 1)) * 10) / 10 : 0; // Stichprobe
+  o["min"]   = min;
+  o["minAt"] = minAt;
+  o["max"]   = max;
+  o["maxAt"] = maxAt;
+}
+
+void LogStats::add(const LogRecord& r) {
+  const int32_t pw = (int32_t)r.bus_mV * r.curr_mA / 1000; // wie LogAggregate
+  if (n) {
+    const uint32_t dt = r.epoch - last;
+    if (dt > kMaxGapSec) {
+      gaps++;
+    } else {
+      mWh += (prevP + pw) * 0.5 * dt / 3600.0;
+      mAh += (prevI + r.curr_mA) * 0.5 * dt / 3600.0;
+      covered += dt;
     }
+  } else {
+    first = r.epoch;
+  }
+  n++;
+  last = r.epoch;
+  v.add(r.bus_mV, r.epoch, n);
+  i.add(r.curr_mA, r.epoch, n);
+  p.add(pw, r.epoch, n);
+  prevI = r.curr_mA;
+  prevP = pw;
+}
+
+void LogStats::toJson(JsonDocument& doc) const {
+  doc["n"]       = n;
+  doc["first"]   = first;
+  doc["last"]    = last;
+  doc["gaps"]    = gaps;
+  doc["covered"] = covered;
+  doc["mWh"]     = round(mWh * 100) / 100;
+  doc["mAh"]     = round(mAh * 100) / 100;
+  if (n == 0) return;
+  v.toJson(doc.createNestedObject("bus_mV"), n);
+  i.toJson(doc.createNestedObject("curr_mA"), n);
+  p.toJson(doc.createNestedObject("power_mW"), n);
+}
+
+// ---- LogBudget ----
+
+void LogBudget::toJson(JsonDocument& doc) const {
+  doc["maxBytes"] = maxBytes;
+  doc["reserveBytes"] = reserveBytes;
+}
+
+bool LogBudget::fromJson(const JsonDocument& doc, const char*& err) {
+  const long mx = doc["maxBytes"] | 0L;
+  const long rs = doc["reserveBytes"] | (long)LOG_FS_RESERVE;
+  if (mx < 0 || (mx > 0 && mx < 16L * 1024L)) {
+    err = "bad maxBytes";
+    return false;
   }
-  if (count == 0) {
-    minIdx = maxIdx = -1;
+  if (rs < 0) {
+    err = "bad reserveBytes";
+    return false;
   }
+  maxBytes = (uint32_t)mx;
+  reserveBytes = (uint32_t)rs;
+  return true;
 }
 
-bool DataLogger::createNewFile(int index) {
-  const String fname = makeName(_prefix, index, _ext);
-  _currentPath  = joinPath(_dir, fname);
-  File f = LittleFS.open(_currentPath, "w");
-  if (!f) return false;
-  // Kompakter Header: nur epoch;bus_V;curr_mA
-  f.println(F("epoch;bus_V;curr_mA"));
-  f.close();
-  _currentIndex = index;
+// ---- DataLogger ----
+
+bool DataLogger::ensureDir() const {
+  if (LittleFS.exists(_dir)) return true;
+  return LittleFS.mkdir(_dir);
+}
+
+void DataLogger::setFlushPolicy(size_t records, unsigned long maxAgeMs) {
+  _raw.setFlushPolicy(records, maxAgeMs);
+  // Rollup-Sätze fallen selten an: Puffer voll ausnutzen, aber nicht länger halten als Rohdaten
+  for (size_t i = 0; i < kMaxTiers; ++i) {
+    _tiers[i].store.setFlushPolicy(LogStore::kBufferBytes / sizeof(RollupRecord), maxAgeMs);
+  }
+}
+
+void DataLogger::setPacking(bool on) {
+  _raw.setPacking(on);
+  for (size_t i = 0; i < kMaxTiers; ++i) _tiers[i].store.setPacking(on);
+}
+
+bool DataLogger::addTier(const char* prefix, uint32_t periodSec, size_t maxFileSize, size_t maxFiles) {
+  if (_tierCount >= kMaxTiers || periodSec == 0) return false;
+  if (_tierCount && periodSec <= _tiers[_tierCount - 1].period) return false;
+  Tier& t = _tiers[_tierCount++];
+  t.prefix      = prefix;
+  t.period      = periodSec;
+  t.maxFileSize = maxFileSize;
+  t.maxFiles    = maxFiles;
   return true;
 }
 
 bool DataLogger::begin(const char* dirPath, const char* prefix, const char* ext,
                        size_t maxFileSize, size_t maxFiles) {
   _dir = dirPath;
-  _prefix = prefix;
   _ext = ext;
-  _maxFileSize = maxFileSize;
-  _maxFiles = maxFiles;
+  _rawFileSize = maxFileSize;
+  _rawFiles = maxFiles;
+  if (!_raw.begin(dirPath, prefix, ext, sizeof(LogRecord), maxFileSize, maxFiles)) return false;
 
-  if (!ensureDir()) return false;
+  // Rollup-Stufen im selben Verzeichnis; Fehler hier legen die Rohdaten nicht lahm
+  for (size_t i = 0; i < _tierCount; ++i) {
+    Tier& t = _tiers[i];
+    t.pending = LogAggregate();
+    if (!t.store.begin(dirPath, t.prefix.c_str(), ext, sizeof(RollupRecord), t.maxFileSize, t.maxFiles)) {
+      Serial.printf("[LOG] tier %s init failed\n", t.prefix.c_str());
+    }
+  }
 
-  int minIdx, maxIdx;
-  size_t count;
-  scanExisting(minIdx, maxIdx, count);
+  // erst jetzt ist bekannt, wie viel die vorhandenen Dateien belegen
+  loadBudget();
+  applyBudget();
+  return true;
+}
 
-  if (count == 0) {
-    // erste Datei
-    return createNewFile(0);
-  } else {
-    _currentIndex = maxIdx;
-    _currentPath  = joinPath(_dir, makeName(_prefix, _currentIndex, _ext));
-    if (!LittleFS.exists(_currentPath)) {
-      // Sicherheitsnetz, falls die ermittelte Datei fehlt
-      return createNewFile(maxIdx >= 0 ? maxIdx + 1 : 0);
+void DataLogger::loadBudget() {
+  _budget = LogBudget();
+  if (!_configPath.length()) return;
+  File f = LittleFS.open(_configPath, "r");
+  if (!f) return;
+  StaticJsonDocument<128> doc;
+  const DeserializationError err = deserializeJson(doc, f);
+  f.close();
+  const char* why = "";
+  if (err || !_budget.fromJson(doc, why)) {
+    Serial.printf("[LOG] %s ungültig, Budget automatisch\n", _configPath.c_str());
+    _budget = LogBudget();
+  }
+}
+
+bool DataLogger::setBudget(const LogBudget& b) {
+  if (_configPath.length()) {
+    StaticJsonDocument<128> doc;
+    b.toJson(doc);
+    // erst vollständig in eine Hilfsdatei, dann umbenennen
+    const String tmp = _configPath + ".tmp";
+    File f = LittleFS.open(tmp, "w");
+    if (!f) return false;
+    const size_t w = serializeJson(doc, f);
+    f.close();
+    if (w == 0 || !LittleFS.rename(tmp, _configPath)) {
+      LittleFS.remove(tmp);
+      return false;
     }
-    return true;
   }
+  _budget = b;
+  applyBudget();
+  return true;
 }
 
-bool DataLogger::append(const Measurement& m, const String&) {
-  // epoch (Sekunden), Spannung in mV (int), Strom in mA (int)
-  int32_t epoch   = (m.epoch > 0) ? (int32_t)m.epoch : 0;
-  int32_t bus_mV  = (int32_t)lroundf(m.busV   * 1000.0f);
-  int32_t curr_mA = (int32_t)lroundf(m.currmA);
+// Grenzen eines Dateisatzes für target Byte: zuerst mehr Dateien in der
+// Grundgröße, ab LOG_AUTO_MAX_FILES größere Dateien (ganze FS-Blöcke)
+static void sizeStore(LogStore& s, size_t fileSize, uint64_t target, size_t block) {
+  if (!s.ready() || fileSize == 0) return;
+  uint64_t files = target / fileSize;
+  if (files > LOG_AUTO_MAX_FILES) {
+    const uint64_t grown = (target / LOG_AUTO_MAX_FILES + block - 1) / block * block;
+    fileSize = (size_t)min(grown, (uint64_t)LOG_AUTO_MAX_FILE_SIZE);
+    files = target / fileSize;
+  }
+  files = constrain(files, (uint64_t)2, (uint64_t)LOG_AUTO_MAX_FILES);
+  s.setLimits(fileSize, (size_t)files);
+}
 
-  File f = LittleFS.open(_currentPath, "a");
-  if (!f) return false;
+// Verteilt das Flash-Budget auf Rohdaten und Stufen im Verhältnis ihrer
+// Grundaufteilung. Grundlage ist der freie Platz plus das, was die Logs selbst
+// schon belegen – das Budget bleibt also über Neustarts gleich.
+void DataLogger::applyBudget() {
+  FSInfo fsi;
+  if (!LittleFS.info(fsi) || !fsi.blockSize) return;
 
-  f.print(epoch);   f.print(';');
-  f.print(bus_mV);  f.print(';');   // mV (integer)
-  f.println(curr_mA);               // mA (integer)
-  f.close();
+  uint64_t own = _raw.allocatedBytes();
+  uint64_t base = (uint64_t)_rawFileSize * _rawFiles;
+  for (size_t i = 0; i < _tierCount; ++i) {
+    own += _tiers[i].store.allocatedBytes();
+    base += (uint64_t)_tiers[i].maxFileSize * _tiers[i].maxFiles;
+  }
+  if (base == 0) return;
+  const uint64_t avail = (uint64_t)fsi.totalBytes - min((uint64_t)fsi.usedBytes, (uint64_t)fsi.totalBytes) + own;
+  uint64_t budget = avail > _budget.reserveBytes ? avail - _budget.reserveBytes : 0;
+  if (_budget.maxBytes && _budget.maxBytes < budget) budget = _budget.maxBytes;
+  _budgetBytes = (uint32_t)min(budget, (uint64_t)0xFFFFFFFFUL);
+
+  sizeStore(_raw, _rawFileSize, budget * _rawFileSize * _rawFiles / base, fsi.blockSize);
+  for (size_t i = 0; i < _tierCount; ++i) {
+    Tier& t = _tiers[i];
+    sizeStore(t.store, t.maxFileSize, budget * t.maxFileSize * t.maxFiles / base, fsi.blockSize);
+  }
+  Serial.printf("[LOG] Budget %lu B: %u x %u B Rohdaten\n", (unsigned long)_budgetBytes,
+                (unsigned)_raw.maxFiles(), (unsigned)_raw.maxFileSize());
+}
 
-  return rotateIfNeeded();
+void DataLogger::makeRecord(const Measurement& m, LogRecord& out) {
+  // epoch (Sekunden), Spannung in mV, Strom in mA – auf die Feldbreite begrenzt
+  const long bus_mV  = lroundf(m.busV * 1000.0f);
+  const long curr_mA = lroundf(m.currmA);
+  out.epoch   = (m.epoch > 0) ? (uint32_t)m.epoch : 0;
+  out.bus_mV  = (uint16_t)constrain(bus_mV, 0L, 65535L);
+  out.curr_mA = (int16_t)constrain(curr_mA, -32768L, 32767L);
 }
 
-bool DataLogger::rotateIfNeeded() {
-  File f = LittleFS.open(_currentPath, "r");
-  size_t size = f ? f.size() : 0;
-  if (f) f.close();
-  if (size < _maxFileSize) return true;
+static char* putUInt(char* p, uint32_t v) {
+  char tmp[10];
+  int n = 0;
+  do { tmp[n++] = (char)('0' + v % 10); v /= 10; } while (v);
+  while (n) *p++ = tmp[--n];
+  return p;
+}
 
-  int minIdx, maxIdx;
-  size_t count;
-  scanExisting(minIdx, maxIdx, count);
+size_t DataLogger::formatCSV(const LogRecord& r, char* out, size_t cap) {
+  if (cap < kMaxCSVLine) return 0;
+  // ohne printf: wird für jeden gestreamten Satz aufgerufen
+  char* p = putUInt(out, r.epoch);
+  *p++ = ';';
+  p = putUInt(p, r.bus_mV);
+  *p++ = ';';
+  int32_t mA = r.curr_mA;
+  if (mA < 0) { *p++ = '-'; mA = -mA; }
+  p = putUInt(p, (uint32_t)mA);
+  *p++ = '\n';
+  return p - out;
+}
 
-  const int nextIdx = (count == 0) ? 0 : (maxIdx + 1);
+// Offene Periode jeder Stufe fortschreiben; beim Periodenwechsel einen Satz anhängen
+// (Min/Max aus der schnellen Abtastung, damit kurze Spitzen in den Stufen erhalten bleiben)
+void DataLogger::updateTiers(const LogRecord& rec, const Measurement& m) {
+  if (!rec.epoch) return; // ohne Zeit keine Zuordnung zur Periode
 
-  if (count >= _maxFiles && minIdx >= 0) {
-    const String oldestPath = joinPath(_dir, makeName(_prefix, minIdx, _ext));
-    LittleFS.remove(oldestPath);
-    // count reduziert sich implizit; wir brauchen es nicht weiter
+  for (size_t i = 0; i < _tierCount; ++i) {
+    Tier& t = _tiers[i];
+    const uint32_t start = rec.epoch - rec.epoch % t.period;
+    // Zeitsprung zurück (NTP) bleibt in der offenen Periode, damit die Datei geordnet bleibt
+    if (t.pending.n && start > t.pending.t) {
+      RollupRecord r;
+      t.pending.toRecord(r);
+      t.store.append(&r);
+      t.pending = LogAggregate();
+    }
+    if (t.pending.n == 0) t.pending.t = start;
+    t.pending.add(rec);
+    t.pending.widen(m);
   }
+}
 
-  return createNewFile(nextIdx);
+bool DataLogger::append(const Measurement& m, const String&) {
+  LogRecord rec;
+  makeRecord(m, rec);
+  updateTiers(rec, m);
+  return _raw.append(&rec);
 }
 
-size_t DataLogger::listFilesJSON(String& outJson) const {
-  struct Item { int idx; String name; size_t size; };
-  Item items[64];
-  size_t n = 0;
+void DataLogger::loop() {
+  _raw.loop();
+  for (size_t i = 0; i < _tierCount; ++i) _tiers[i].store.loop();
+}
 
-  Dir dir = LittleFS.openDir(_dir);
-  while (dir.next()) {
-    yield(); // WDT füttern während Dir-Iteration
-    const String fname = dir.fileName();
-    int idx;
-    if (parseIndex(fname, _prefix, _ext, idx)) {
-      if (n < 64) {
-        items[n].idx  = idx;
-        items[n].name = (_dir.endsWith("/") ? _dir : _dir + "/") + fname;
-        File f = LittleFS.open(items[n].name, "r");
-        items[n].size = f ? f.size() : 0;
-        if (f) f.close();
-        n++;
-        yield(); // WDT nach File-Open/Close
-      }
-    }
+bool DataLogger::flush() {
+  bool ok = _raw.flush();
+  for (size_t i = 0; i < _tierCount; ++i) {
+    if (_tiers[i].store.ready()) ok = _tiers[i].store.flush() && ok;
   }
+  return ok;
+}
 
-  // einfache Insertion-Sort nach idx
-  for (size_t i = 1; i < n; ++i) {
-    Item key = items[i];
-    size_t j = i;
-    while (j > 0 && items[j-1].idx > key.idx) { items[j] = items[j-1]; j--; }
-    items[j] = key;
+uint32_t DataLogger::firstEpoch() const {
+  uint32_t first = _raw.firstEpoch();
+  for (size_t i = 0; i < _tierCount; ++i) {
+    const uint32_t e = _tiers[i].store.firstEpoch();
+    if (e && (!first || e < first)) first = e;
+  }
+  return first;
+}
+
+int DataLogger::pickTier(uint32_t t0, uint32_t maxPeriodSec) const {
+  int best = -1;
+  uint32_t bestFirst = _raw.firstEpoch();
+  for (size_t i = 0; i < _tierCount; ++i) {
+    const Tier& t = _tiers[i];
+    if (t.period > maxPeriodSec) break; // Stufen sind nach Periode sortiert
+    const uint32_t first = t.store.firstEpoch();
+    if (!first) continue;
+    // gröber nur, wenn dadurch keine Historie im Fenster verloren geht
+    if (!bestFirst || first <= max(t0, bestFirst)) {
+      best = (int)i;
+      bestFirst = first;
+    }
   }
+  return best;
+}
 
-  String json = "[";
+size_t DataLogger::listFilesJSON(String& outJson) const {
+  const size_t n = _raw.segmentCount();
+  String json;
+  json.reserve(16 + n * 80);
+  json += "[";
   for (size_t i = 0; i < n; ++i) {
+    const LogSegment& seg = _raw.segment(i);
     if (i) json += ",";
-    json += "{\"name\":\"" + items[i].name + "\",\"size\":" + String(items[i].size) + "}";
+    json += "{\"name\":\"" + _raw.segmentPath(i) + "\",\"size\":" + String(seg.size) +
+            ",\"first\":" + String(seg.firstEpoch) + ",\"last\":" + String(seg.lastEpoch) +
+            ",\"packed\":" + (seg.packed ? "true" : "false") + "}";
   }
   json += "]";
   outJson = json;
@@ -170,7 +437,7 @@ size_t DataLogger::listFilesJSON(String& outJson) const {
 bool DataLogger::clearAll() {
   if (!ensureDir()) return false;
 
-  // alle Dateien im Log-Verzeichnis löschen
+  // alle Dateien im Log-Verzeichnis löschen (auch Reste fremder Formate)
   Dir dir = LittleFS.openDir(_dir);
   while (dir.next()) {
     yield();
@@ -183,10 +450,12 @@ bool DataLogger::clearAll() {
     LittleFS.remove(p);
   }
 
-  // internen Zustand zurücksetzen (optional, begin setzt ohnehin neu)
-  _currentIndex = -1;
-  _currentPath  = String();
-
-  // frisch initialisieren – begin legt "log_0000.csv" an und schreibt den Header
-  return begin(_dir.c_str(), _prefix.c_str(), _ext.c_str(), _maxFileSize, _maxFiles);
-}
\ No newline at end of file
+  // gepufferte Sätze und offene Perioden gehören zu den gelöschten Daten;
+  // jede Stufe legt ihre Datei "<prefix>0000.bin" frisch an
+  bool ok = _raw.clearAll();
+  for (size_t i = 0; i < _tierCount; ++i) {
+    _tiers[i].pending = LogAggregate();
+    _tiers[i].store.clearAll();
+  }
+  return ok;
+}
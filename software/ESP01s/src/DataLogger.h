@@ -1,39 +1,191 @@
 #pragma once
 #include <Arduino.h>
 #include <LittleFS.h>
+#include <ArduinoJson.h>
+#include "Config.h"
+#include "LogStore.h"
 #include "Measurement.h"
 
+// Rohsatz (8 Byte), Dateiformat siehe LogStore.h
+struct __attribute__((packed)) LogRecord {
+  uint32_t epoch;    // Sekunden (0 = Zeit noch nicht synchron)
+  uint16_t bus_mV;   // Busspannung in mV
+  int16_t  curr_mA;  // Strom in mA
+};
+
+// Verdichteter Satz einer Rollup-Stufe (24 Byte): min/max/Mittel einer Periode
+struct __attribute__((packed)) RollupRecord {
+  uint32_t epoch;               // Beginn der Periode
+  uint16_t n;                   // Anzahl zusammengefasster Rohsätze
+  uint16_t vMin, vMax, vAvg;    // Busspannung in mV
+  int16_t  iMin, iMax, iAvg;    // Strom in mA
+  int16_t  pMin, pMax, pAvg;    // Leistung in 10 mW
+};
+
+// Min/Max/Summen über Roh- oder Rollup-Sätze (mV, mA, mW). Wird für die
+// Rollup-Stufen und für die Buckets von /api/logs/agg verwendet.
+struct LogAggregate {
+  uint32_t t = 0;   // Beginn der Periode / des Buckets
+  uint32_t n = 0;   // Anzahl Rohsätze
+  uint16_t vMin = 0, vMax = 0;
+  int16_t  iMin = 0, iMax = 0;
+  int32_t  pMin = 0, pMax = 0;
+  int64_t  vSum = 0, iSum = 0, pSum = 0;
+
+  void add(const LogRecord& r);
+  void add(const RollupRecord& r);   // gewichtet mit r.n
+  void add(const LogAggregate& a);
+  // Min/Max um die Extremwerte eines Logintervalls erweitern (schnelle Abtastung)
+  void widen(const Measurement& m);
+  void toRecord(RollupRecord& out) const;
+
+  // CSV-Zeile "epoch;n;bus_mV_min;..;power_mW_avg\n" (Länge, 0 bei Fehler)
+  static const size_t kMaxCSVLine = 96;
+  size_t formatCSV(char* out, size_t cap) const;
+};
+
+// Kennzahlen eines Zeitfensters in einem Durchlauf über die Rohsätze (für
+// /api/logs/stats): Mittel und Streuung nach Welford, Extremwerte mit
+// Zeitpunkt, Energie und Ladung per Trapezregel. Der Zustand ist fest, egal
+// wie lang das Fenster ist.
+struct LogStats {
+  // längere Abstände zwischen zwei Sätzen (Gerät aus) zählen als Lücke und
+  // gehen nicht in Energie/Ladung ein
+  static const uint32_t kMaxGapSec = 60;
+
+  struct Series {
+    double mean = 0, m2 = 0;      // Welford: Mittel, Summe der Abweichungsquadrate
+    int32_t min = 0, max = 0;
+    uint32_t minAt = 0, maxAt = 0;
+
+    void add(int32_t v, uint32_t epoch, uint32_t n); // n = Anzahl inkl. v
+    void toJson(JsonObject o, uint32_t n) const;
+  };
+
+  uint32_t n = 0;                 // Sätze mit gültiger Zeit
+  uint32_t first = 0, last = 0;   // erster/letzter Satz
+  uint32_t gaps = 0;
+  uint32_t covered = 0;           // integrierte Sekunden (ohne Lücken)
+  Series v, i, p;                 // mV, mA, mW
+  double mWh = 0, mAh = 0;
+  int16_t prevI = 0;
+  int32_t prevP = 0;
+
+  void add(const LogRecord& r);   // Sätze zeitlich aufsteigend, epoch != 0
+  void toJson(JsonDocument& doc) const;
+};
+
+// Flash-Budget der Logs (Inhalt von /logger.json)
+struct LogBudget {
+  uint32_t maxBytes = 0;                   // Obergrenze aller Logdateien, 0 = freier Platz
+  uint32_t reserveBytes = LOG_FS_RESERVE;  // bleibt im Dateisystem frei
+
+  void toJson(JsonDocument& doc) const;
+  // Übernimmt die Felder aus doc (fehlende = Standardwert); bei ungültigen
+  // Werten false und err = Grund, *this bleibt dann unverändert
+  bool fromJson(const JsonDocument& doc, const char*& err);
+};
+
 class DataLogger {
 public:
-  // Initialisiert Logger (Rotation): z.B. dir="/logs", prefix="log_", ext=".csv"
+  // Höchstzahl an Rollup-Stufen
+  static const size_t kMaxTiers = 2;
+
+  // Schreibpuffer: Flush nach 'records' Sätzen oder spätestens nach 'maxAgeMs'
+  // (Rollup-Stufen schreiben spätestens nach derselben Zeit)
+  void setFlushPolicy(size_t records, unsigned long maxAgeMs);
+
+  // Volle Segmente (Rohdaten und Rollup-Stufen) beim Rotieren packen, siehe
+  // LogStore::setPacking (vor begin())
+  void setPacking(bool on);
+
+  // Datei mit dem Flash-Budget (vor begin(), z.B. "/logger.json"); ohne
+  // Pfad oder Datei gilt LogBudget() – also automatisch nach freiem Platz
+  void setConfigPath(const char* path) { _configPath = path; }
+
+  // Rollup-Stufe anmelden (vor begin(), aufsteigend nach Periode): eigener
+  // rotierender Dateisatz im Log-Verzeichnis, z.B. prefix="m01_", periodSec=60
+  bool addTier(const char* prefix, uint32_t periodSec, size_t maxFileSize, size_t maxFiles);
+
+  // Initialisiert Logger (Rotation): z.B. dir="/logs", prefix="log_", ext=".bin".
+  // maxFileSize/maxFiles (und die Werte der Stufen) sind die Grundaufteilung,
+  // die tatsächlichen Grenzen ergeben sich aus dem Flash-Budget
   bool begin(const char* dirPath, const char* prefix, const char* ext,
              size_t maxFileSize, size_t maxFiles);
 
-  // Schreibt einen Datensatz (epoch;bus_mV;curr_mA) und prüft ggf. Rotation
+  // Puffert einen Datensatz (LogRecord) im RAM, schreibt gemäß Flush-Policy und prüft ggf. Rotation;
+  // führt die Rollup-Stufen inkrementell mit
   bool append(const Measurement& m, const String& isoLocal /*unused*/);
 
-  // Liefert JSON-Array mit {name,size} aller Log-Dateien (aufsteigend sortiert)
+  // Zeitgesteuerter Flush (aus loop() aufrufen)
+  void loop();
+
+  // Schreibt gepufferte Sätze aller Stufen (vor jedem Lesezugriff aufrufen)
+  bool flush();
+
+  // Flash-Budget: eingestellte Grenzen und daraus berechnete Gesamtgröße
+  const LogBudget& budget() const { return _budget; }
+  uint32_t budgetBytes() const { return _budgetBytes; }
+  // Speichert b (Hilfsdatei + rename) und verteilt das Budget sofort neu;
+  // false = Schreiben fehlgeschlagen
+  bool setBudget(const LogBudget& b);
+
+  // Liefert JSON-Array mit {name,size,first,last,packed} aller Roh-Logdateien (aufsteigend sortiert)
   size_t listFilesJSON(String& outJson) const;
 
-  // Aktueller Dateipfad
-  String currentFilePath() const { return _currentPath; }
+  // Rohdaten (5-s-Sätze)
+  LogStore& raw() { return _raw; }
+  const LogStore& raw() const { return _raw; }
 
-  // Löscht alle Log-Dateien und startet frisch (begin(...) intern erneut aufgerufen)
+  // Rollup-Stufen (0 = feinste)
+  size_t tierCount() const { return _tierCount; }
+  LogStore& tier(size_t i) { return _tiers[i].store; }
+  uint32_t tierPeriod(size_t i) const { return _tiers[i].period; }
+  // noch offene (nicht geschriebene) Periode der Stufe, n == 0 = keine
+  const LogAggregate& tierPending(size_t i) const { return _tiers[i].pending; }
+
+  // Gröbste Stufe mit Periode <= maxPeriodSec, die ab t0 mindestens so weit
+  // zurückreicht wie die feineren Quellen; -1 = Rohdaten
+  int pickTier(uint32_t t0, uint32_t maxPeriodSec) const;
+
+  // Ältester/jüngster Satz mit gültiger Zeit über Rohdaten und Stufen (0 = keiner)
+  uint32_t firstEpoch() const;
+  uint32_t lastEpoch() const { return _raw.lastEpoch(); }
+
+  // Aktueller Dateipfad der Rohdaten
+  String currentFilePath() const { return _raw.currentFilePath(); }
+
+  // Löscht alle Log-Dateien samt Schreibpuffern und startet frisch (begin(...) intern erneut aufgerufen)
   bool clearAll();
 
+  // Formatiert einen Satz als CSV-Zeile "epoch;bus_mV;curr_mA\n" (Länge, 0 bei Fehler)
+  static const size_t kMaxCSVLine = 24; // "4294967295;65535;-32768\n"
+  static size_t formatCSV(const LogRecord& r, char* out, size_t cap);
+
 private:
+  struct Tier {
+    LogStore store;
+    String prefix;
+    uint32_t period = 0;
+    size_t maxFileSize = 0;
+    size_t maxFiles = 0;
+    LogAggregate pending;
+  };
+
   String _dir;
-  String _prefix;
   String _ext;
-  size_t _maxFileSize = 0;
-  size_t _maxFiles = 0;
-  String _currentPath;
-  int _currentIndex = -1;
+  String _configPath;
+  LogBudget _budget;
+  uint32_t _budgetBytes = 0;
+  size_t _rawFileSize = 0;   // Grundaufteilung der Rohdaten
+  size_t _rawFiles = 0;
+  LogStore _raw;
+  Tier _tiers[kMaxTiers];
+  size_t _tierCount = 0;
 
   bool ensureDir() const;
-  void scanExisting(int& minIdx, int& maxIdx, size_t& count) const;
-  static bool parseIndex(const String& name, const String& prefix, const String& ext, int& out);
-  static String makeName(const String& prefix, int index, const String& ext);
-  bool createNewFile(int index);
-  bool rotateIfNeeded();
-};
\ No newline at end of file
+  void loadBudget();
+  void applyBudget();
+  static void makeRecord(const Measurement& m, LogRecord& out);
+  void updateTiers(const LogRecord& rec, const Measurement& m);
+};
@@ -0,0 +1,104 @@
+#include "EnergyMeter.h"
+#include <ArduinoJson.h>
+
+uint32_t EnergyMeter::dayOf(time_t epoch) {
+  if (epoch <= 0) return 0;
+  struct tm lt;
+  localtime_r(&epoch, &lt);
+  return (uint32_t)(lt.tm_year + 1900) * 10000 + (lt.tm_mon + 1) * 100 + lt.tm_mday;
+}
+
+void EnergyMeter::begin(const char* path, unsigned long checkpointMs) {
+  _path = path;
+  _checkpointMs = checkpointMs;
+  _lastCheckpoint = millis();
+  _dirty = false;
+  if (!load()) {
+    Serial.println(F("[ENERGY] no checkpoint, starting at 0"));
+  }
+}
+
+bool EnergyMeter::load() {
+  File f = LittleFS.open(_path, "r");
+  if (!f) return false;
+  StaticJsonDocument<384> doc;
+  DeserializationError err = deserializeJson(doc, f);
+  f.close();
+  if (err) return false;
+
+  _session.mWh  = doc["session"]["mWh"] | 0.0;
+  _session.mAh  = doc["session"]["mAh"] | 0.0;
+  _sessionStart = doc["session"]["since"] | 0UL;
+  _today.mWh    = doc["today"]["mWh"] | 0.0;
+  _today.mAh    = doc["today"]["mAh"] | 0.0;
+  _day          = doc["today"]["day"] | 0UL;
+  _total.mWh    = doc["total"]["mWh"] | 0.0;
+  _total.mAh    = doc["total"]["mAh"] | 0.0;
+  return true;
+}
+
+bool EnergyMeter::checkpoint() {
+  StaticJsonDocument<384> doc;
+  JsonObject s = doc.createNestedObject("session");
+  s["mWh"]   = _session.mWh;
+  s["mAh"]   = _session.mAh;
+  s["since"] = _sessionStart;
+  JsonObject d = doc.createNestedObject("today");
+  d["mWh"] = _today.mWh;
+  d["mAh"] = _today.mAh;
+  d["day"] = _day;
+  JsonObject t = doc.createNestedObject("total");
+  t["mWh"] = _total.mWh;
+  t["mAh"] = _total.mAh;
+
+  // erst vollständig in eine Hilfsdatei, dann umbenennen: ein Stromausfall
+  // beim Schreiben lässt den alten Stand intakt
+  const String tmp = _path + ".tmp";
+  File f = LittleFS.open(tmp, "w");
+  if (!f) return false;
+  const size_t w = serializeJson(doc, f);
+  f.close();
+  if (w == 0 || !LittleFS.rename(tmp, _path)) {
+    LittleFS.remove(tmp);
+    return false;
+  }
+  _dirty = false;
+  _lastCheckpoint = millis();
+  return true;
+}
+
+void EnergyMeter::add(const Measurement& m) {
+  if (m.samples == 0) return;
+
+  // Tageswechsel (lokale Zeit); ohne gültige Zeit zählt der bisherige Tag weiter
+  const uint32_t d = dayOf(m.epoch);
+  if (d && d != _day) {
+    if (_day) _today = Totals();
+    _day = d;
+  }
+  if (!_sessionStart && m.epoch > 0) _sessionStart = (uint32_t)m.epoch;
+
+  _session.mWh += m.energymWh;
+  _session.mAh += m.chargemAh;
+  _today.mWh   += m.energymWh;
+  _today.mAh   += m.chargemAh;
+  _total.mWh   += m.energymWh;
+  _total.mAh   += m.chargemAh;
+  _dirty = true;
+}
+
+void EnergyMeter::loop() {
+  if (_dirty && millis() - _lastCheckpoint >= _checkpointMs) {
+    if (!checkpoint()) {
+      _lastCheckpoint = millis(); // nicht in jeder loop() erneut versuchen
+      Serial.println(F("[ENERGY] checkpoint failed"));
+    }
+  }
+}
+
+void EnergyMeter::resetSession() {
+  _session = Totals();
+  const time_t now = time(nullptr);
+  _sessionStart = (now >= 100000) ? (uint32_t)now : 0; // wie TimeService: < 100000 = nicht synchron
+  checkpoint();
+}
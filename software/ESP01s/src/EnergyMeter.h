@@ -0,0 +1,53 @@
+#pragma once
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <time.h>
+#include "Measurement.h"
+
+// Summiert Energie (mWh) und Ladung (mAh) aus den Intervallwerten der
+// schnellen Abtastung: je Sitzung (bis zum Zurücksetzen), je Kalendertag
+// (lokale Zeit) und gesamt. Stände werden periodisch nach LittleFS geschrieben
+// und beim Start wieder geladen.
+class EnergyMeter {
+public:
+  struct Totals {
+    double mWh = 0;
+    double mAh = 0;
+  };
+
+  // Lädt den letzten Stand aus path (z.B. "/energy.json")
+  void begin(const char* path, unsigned long checkpointMs);
+
+  // Intervall aus SensorINA219::takeInterval aufaddieren
+  void add(const Measurement& m);
+
+  // Checkpoint bei Fälligkeit (aus loop() aufrufen)
+  void loop();
+
+  // Stand sofort schreiben (tmp + rename)
+  bool checkpoint();
+
+  // Sitzung auf 0 setzen (Tag und Gesamt bleiben)
+  void resetSession();
+
+  const Totals& session() const { return _session; }
+  const Totals& today() const { return _today; }
+  const Totals& total() const { return _total; }
+  uint32_t sessionStart() const { return _sessionStart; } // epoch, 0 = unbekannt
+  uint32_t day() const { return _day; }                   // JJJJMMTT, 0 = unbekannt
+
+private:
+  String _path;
+  unsigned long _checkpointMs = 0;
+  unsigned long _lastCheckpoint = 0;
+  bool _dirty = false;
+
+  Totals _session;
+  Totals _today;
+  Totals _total;
+  uint32_t _sessionStart = 0;
+  uint32_t _day = 0;
+
+  static uint32_t dayOf(time_t epoch);
+  bool load();
+};
@@ -0,0 +1,305 @@
+#include "EventDetector.h"
+#include <LittleFS.h>
+#include <algorithm>
+#include <math.h>
+
+// Festspannungen nach USB Power Delivery (SPR/EPR)
+static const uint8_t kPdLevels[] = {5, 9, 12, 15, 20, 28};
+// darunter gilt der Ausgang als aus (Stufe 0)
+static const float kPdOffV = 3.0f;
+
+static const char* const kKindNames[] = {"rising", "falling", "rate", "pd"};
+static const char* const kSignalNames[] = {"voltage", "current", "power"};
+
+template <size_t N>
+static int lookup(const char* const (&names)[N], const char* s) {
+  if (!s) return -1;
+  for (size_t k = 0; k < N; ++k) {
+    if (strcmp(names[k], s) == 0) return (int)k;
+  }
+  return -1;
+}
+
+// ---- EventConfig ----
+
+EventConfig::EventConfig() {
+  rules[0].kind = EventRule::PdLevel;
+  rules[0].signal = EventRule::Voltage;
+  rules[0].threshold = 0.6f;
+  count = 1;
+}
+
+void EventConfig::toJson(JsonDocument& doc) const {
+  JsonArray arr = doc.createNestedArray("rules");
+  for (size_t k = 0; k < count; ++k) {
+    const EventRule& r = rules[k];
+    JsonObject o = arr.createNestedObject();
+    o["kind"] = kKindNames[r.kind];
+    o["signal"] = kSignalNames[r.signal];
+    o["threshold"] = r.threshold;
+    o["hysteresis"] = r.hysteresis;
+  }
+}
+
+bool EventConfig::fromJson(const JsonDocument& doc, const char*& err) {
+  JsonArrayConst arr = doc["rules"].as<JsonArrayConst>();
+  if (arr.isNull()) {
+    err = "missing rules";
+    return false;
+  }
+  if (arr.size() > kMaxRules) {
+    err = "too many rules";
+    return false;
+  }
+  EventConfig c;
+  c.count = 0;
+  for (JsonObjectConst o : arr) {
+    EventRule r;
+    const int kind = lookup(kKindNames, o["kind"] | "");
+    const int sig = lookup(kSignalNames, o["signal"] | "voltage");
+    if (kind < 0) { err = "bad kind"; return false; }
+    if (sig < 0) { err = "bad signal"; return false; }
+    r.kind = (EventRule::Kind)kind;
+    r.signal = (r.kind == EventRule::PdLevel) ? EventRule::Voltage : (EventRule::Signal)sig;
+    r.threshold = o["threshold"] | (r.kind == EventRule::PdLevel ? 0.6f : 0.0f);
+    r.hysteresis = o["hysteresis"] | 0.0f;
+    if (!isfinite(r.threshold) || !isfinite(r.hysteresis) || r.hysteresis < 0) {
+      err = "bad threshold";
+      return false;
+    }
+    // Rate und Toleranz sind Beträge; Toleranz unter dem halben Stufenabstand (9 -> 12 V)
+    if ((r.kind == EventRule::Rate && r.threshold <= 0) ||
+        (r.kind == EventRule::PdLevel && (r.threshold <= 0 || r.threshold >= 1.5f))) {
+      err = "bad threshold";
+      return false;
+    }
+    c.rules[c.count++] = r;
+  }
+  *this = c;
+  return true;
+}
+
+// ---- EventDetector ----
+
+bool EventDetector::begin(const char* configPath, const char* dir, const char* prefix,
+                          size_t maxFileSize, size_t maxFiles) {
+  _configPath = configPath ? configPath : "";
+  loadConfig();
+  resetState();
+  _polling = false;
+  _unsentHead = _unsentCount = 0;
+  // Ereignisse sind selten: gebündelt schreiben, aber spätestens nach 10 s
+  _log.setFlushPolicy(4, 10000);
+  return _log.begin(dir, prefix, ".bin", sizeof(EventRecord), maxFileSize, maxFiles);
+}
+
+void EventDetector::loadConfig() {
+  _config = EventConfig();
+  if (!_configPath.length()) return;
+  File f = LittleFS.open(_configPath, "r");
+  if (!f) return;
+  StaticJsonDocument<1024> doc;
+  const DeserializationError err = deserializeJson(doc, f);
+  f.close();
+  const char* why = "";
+  if (err || !_config.fromJson(doc, why)) {
+    Serial.printf("[EVT] %s ungültig, Standardregeln\n", _configPath.c_str());
+    _config = EventConfig();
+  }
+}
+
+bool EventDetector::setConfig(const EventConfig& c) {
+  if (_configPath.length()) {
+    StaticJsonDocument<1024> doc;
+    c.toJson(doc);
+    // erst vollständig in eine Hilfsdatei, dann umbenennen
+    const String tmp = _configPath + ".tmp";
+    File f = LittleFS.open(tmp, "w");
+    if (!f) return false;
+    const size_t w = serializeJson(doc, f);
+    f.close();
+    if (w == 0 || !LittleFS.rename(tmp, _configPath)) {
+      LittleFS.remove(tmp);
+      return false;
+    }
+  }
+  _config = c;
+  resetState();
+  return true;
+}
+
+void EventDetector::resetState() {
+  for (RuleState& st : _state) st = RuleState();
+  _havePrev = false;
+}
+
+void EventDetector::poll(const SensorINA219& sensor, uint32_t epochNow) {
+  if (!_polling) {
+    _pos = sensor.rawHead(); // ab jetzt
+    _polling = true;
+  }
+  const uint32_t now = millis();
+  const uint16_t period = sensor.periodMs();
+  _periodS = period / 1000.0f;
+  SensorINA219::RawSample buf[16];
+  size_t n;
+  while ((n = sensor.readRaw(_pos, buf, 16)) > 0) {
+    // Zeitpunkt aus dem Abstand zum Schreibkopf: der Ticker tastet im festen Takt ab
+    const size_t behind = (sensor.rawHead() - _pos) & (SensorINA219::kRingSize - 1);
+    for (size_t k = 0; k < n; ++k) {
+      const uint32_t ms = now - (uint32_t)(behind + n - 1 - k) * period;
+      const uint32_t epoch = epochNow ? epochNow - (now - ms) / 1000 : 0;
+      const float v = SensorINA219::busV(buf[k]);
+      const float i = sensor.currentmA(buf[k]);
+      check(buf[k], v, i, v * i / 1000.0f, ms, epoch);
+    }
+  }
+}
+
+uint8_t EventDetector::pdLevel(float v, float tol) {
+  if (v < kPdOffV) return 0;
+  for (uint8_t level : kPdLevels) {
+    if (fabsf(v - level) <= tol) return level;
+  }
+  return 0xFF; // zwischen den Stufen (Übergang)
+}
+
+void EventDetector::check(const SensorINA219::RawSample& s, float v, float i, float p,
+                          uint32_t ms, uint32_t epoch) {
+  const float x[3] = {v, i, p};
+
+  for (size_t k = 0; k < _config.count; ++k) {
+    const EventRule& r = _config.rules[k];
+    RuleState& st = _state[k];
+    const float val = x[r.signal];
+
+    switch (r.kind) {
+      case EventRule::Rising:
+        if (!st.init) st.armed = val < r.threshold; // schon darüber: kein Ereignis beim Start
+        else if (st.armed && val >= r.threshold) {
+          st.armed = false;
+          emit(k, s, i, val, 0, ms, epoch);
+        } else if (!st.armed && val < r.threshold - r.hysteresis) {
+          st.armed = true;
+        }
+        break;
+
+      case EventRule::Falling:
+        if (!st.init) st.armed = val > r.threshold;
+        else if (st.armed && val <= r.threshold) {
+          st.armed = false;
+          emit(k, s, i, val, 0, ms, epoch);
+        } else if (!st.armed && val > r.threshold + r.hysteresis) {
+          st.armed = true;
+        }
+        break;
+
+      case EventRule::Rate: {
+        if (!_havePrev) break;
+        const float rate = (val - _prev[r.signal]) / _periodS; // Abtastungen im festen Takt
+        const bool over = fabsf(rate) >= r.threshold;
+        if (over && !st.active) emit(k, s, i, rate, 0, ms, epoch);
+        st.active = over;
+        break;
+      }
+
+      case EventRule::PdLevel: {
+        // Stufe gilt erst nach kPdStableSamples Abtastungen in Folge
+        const uint8_t lv = pdLevel(v, r.threshold);
+        if (lv == 0xFF || lv != st.candidate) {
+          st.candidate = lv;
+          st.stable = 0;
+        }
+        if (st.stable < kPdStableSamples) st.stable++;
+        if (lv == 0xFF || st.stable < kPdStableSamples || lv == st.level) break;
+        if (st.level != 0xFF) emit(k, s, i, lv, st.level, ms, epoch); // erste Stufe nach dem Start still
+        st.level = lv;
+        break;
+      }
+    }
+    st.init = true;
+  }
+
+  memcpy(_prev, x, sizeof(_prev));
+  _havePrev = true;
+}
+
+void EventDetector::emit(uint8_t rule, const SensorINA219::RawSample& s, float i, float value,
+                         uint8_t fromV, uint32_t ms, uint32_t epoch) {
+  const EventRule& r = _config.rules[rule];
+  EventRecord e;
+  e.epoch   = epoch;
+  e.ms      = ms;
+  e.kind    = r.kind;
+  e.signal  = r.signal;
+  e.rule    = rule;
+  e.fromV   = fromV;
+  e.bus_mV  = (s.bus >> 3) * 4;
+  e.curr_mA = (int16_t)constrain(lroundf(i), -32768L, 32767L);
+  e.value   = value;
+  _log.append(&e);
+  _count++;
+
+  if (_unsentCount == kUnsent) {
+    _unsentHead = (_unsentHead + 1) % kUnsent;
+    _unsentCount--;
+    _dropped++;
+  }
+  _unsent[(_unsentHead + _unsentCount) % kUnsent] = e;
+  _unsentCount++;
+
+  char json[kMaxJSON];
+  if (formatJSON(e, json, sizeof(json))) Serial.printf("[EVT] %s\n", json);
+}
+
+bool EventDetector::peekUnsent(EventRecord& out) const {
+  if (_unsentCount == 0) return false;
+  out = _unsent[_unsentHead];
+  return true;
+}
+
+void EventDetector::popUnsent() {
+  if (_unsentCount == 0) return;
+  _unsentHead = (_unsentHead + 1) % kUnsent;
+  _unsentCount--;
+}
+
+size_t EventDetector::recent(uint32_t since, EventRecord* out, size_t max) {
+  if (max == 0) return 0;
+  _log.flush();
+  LogCursor from;
+  if (since && !_log.findFirst(since, from)) return 0;
+
+  // alles ab from lesen, die letzten max behalten (Ring in out)
+  LogReader rd(_log, from);
+  EventRecord blk[8];
+  size_t total = 0, n;
+  while ((n = rd.read(blk, 8)) > 0) {
+    for (size_t k = 0; k < n; ++k) {
+      if (since && blk[k].epoch < since) continue;
+      out[total++ % max] = blk[k];
+    }
+  }
+  if (total > max) std::rotate(out, out + total % max, out + max);
+  return min(total, max);
+}
+
+size_t EventDetector::formatJSON(const EventRecord& e, char* out, size_t cap) {
+  const char* kind = e.kind < 4 ? kKindNames[e.kind] : "?";
+  const char* sig = e.signal < 3 ? kSignalNames[e.signal] : "?";
+  int n;
+  if (e.kind == EventRule::PdLevel) {
+    n = snprintf(out, cap,
+                 "{\"t\":%lu,\"ms\":%lu,\"rule\":%u,\"kind\":\"%s\",\"bus_mV\":%u,\"curr_mA\":%d,"
+                 "\"from\":%u,\"to\":%u}",
+                 (unsigned long)e.epoch, (unsigned long)e.ms, (unsigned)e.rule, kind,
+                 (unsigned)e.bus_mV, (int)e.curr_mA, (unsigned)e.fromV, (unsigned)lroundf(e.value));
+  } else {
+    n = snprintf(out, cap,
+                 "{\"t\":%lu,\"ms\":%lu,\"rule\":%u,\"kind\":\"%s\",\"signal\":\"%s\",\"bus_mV\":%u,"
+                 "\"curr_mA\":%d,\"value\":%.3f}",
+                 (unsigned long)e.epoch, (unsigned long)e.ms, (unsigned)e.rule, kind, sig,
+                 (unsigned)e.bus_mV, (int)e.curr_mA, (double)e.value);
+  }
+  return (n > 0 && (size_t)n < cap) ? (size_t)n : 0;
+}
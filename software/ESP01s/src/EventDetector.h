@@ -0,0 +1,122 @@
+#pragma once
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "LogStore.h"
+#include "SensorINA219.h"
+
+// Gespeichertes Ereignis (20 Byte, Dateiformat siehe LogStore.h)
+struct __attribute__((packed)) EventRecord {
+  uint32_t epoch;    // Zeit der auslösenden Abtastung (0 = Zeit nicht synchron)
+  uint32_t ms;       // millis() der Abtastung (Abstände auch ohne Zeit)
+  uint8_t  kind;     // EventRule::Kind
+  uint8_t  signal;   // EventRule::Signal
+  uint8_t  rule;     // Index der Regel zum Zeitpunkt des Ereignisses
+  uint8_t  fromV;    // PdLevel: vorherige Stufe in V (0 = aus)
+  uint16_t bus_mV;   // Abtastung, die ausgelöst hat
+  int16_t  curr_mA;
+  float    value;    // Schwelle: Signalwert; Rate: Änderung je s; PdLevel: neue Stufe in V
+};
+
+// Regel, die auf jede Abtastung angewendet wird. Einheiten wie am MQTT-State:
+// V, mA, W (Rate: V/s, mA/s, W/s).
+struct EventRule {
+  enum Kind : uint8_t { Rising, Falling, Rate, PdLevel };
+  enum Signal : uint8_t { Voltage, Current, Power };
+
+  Kind kind = PdLevel;
+  Signal signal = Voltage;  // PdLevel: immer Spannung
+  float threshold = 0;      // Schwelle / Betrag der Änderung je s / PdLevel: Toleranz in V
+  float hysteresis = 0;     // Rising/Falling: erst nach Rückkehr um diesen Betrag wieder scharf
+};
+
+// Regelsatz (Inhalt von /events.json)
+struct EventConfig {
+  static const size_t kMaxRules = 8;
+
+  EventRule rules[kMaxRules];
+  size_t count = 0;
+
+  EventConfig();  // Standard: PD-Stufenwechsel
+  void toJson(JsonDocument& doc) const;
+  // Übernimmt doc["rules"]; bei ungültigen Werten false und err = Grund,
+  // *this bleibt dann unverändert
+  bool fromJson(const JsonDocument& doc, const char*& err);
+};
+
+// Ereigniserkennung in voller Abtastrate: poll() holt aus loop() alle neuen
+// Rohwerte des Sensors (wie die Live-Anzeige) und prüft jede Abtastung gegen
+// die Regeln. Ereignisse gehen in einen eigenen rotierenden Dateisatz und in
+// einen kleinen RAM-Ring, aus dem MQTT sendet.
+class EventDetector {
+public:
+  // noch nicht gesendete Ereignisse (voll -> ältestes verwerfen)
+  static const size_t kUnsent = 8;
+  // Abtastungen in Folge innerhalb der Toleranz, bis eine PD-Stufe gilt
+  static const uint8_t kPdStableSamples = 3;
+
+  // Regeln aus configPath laden (fehlt die Datei: EventConfig()), Ereignislog
+  // öffnen, z.B. dir="/events", prefix="ev_"
+  bool begin(const char* configPath, const char* dir, const char* prefix,
+             size_t maxFileSize, size_t maxFiles);
+
+  // Alle seit dem letzten Aufruf abgetasteten Werte prüfen. Vor jedem
+  // SensorINA219::takeInterval() aufrufen, sonst gibt der Sensor Abtastungen
+  // frei, die hier noch nicht gesehen wurden. epochNow = 0: Zeit nicht synchron.
+  void poll(const SensorINA219& sensor, uint32_t epochNow);
+
+  // Zeitgesteuerter Flush des Ereignislogs (aus loop() aufrufen)
+  void loop() { _log.loop(); }
+
+  const EventConfig& config() const { return _config; }
+  // Speichert c (Hilfsdatei + rename) und setzt den Zustand der Regeln zurück;
+  // false = Schreiben fehlgeschlagen
+  bool setConfig(const EventConfig& c);
+
+  // Die jüngsten höchstens max Ereignisse mit epoch >= since (0 = alle),
+  // aufsteigend nach Zeit
+  size_t recent(uint32_t since, EventRecord* out, size_t max);
+
+  // Für MQTT: ältestes noch nicht gesendetes Ereignis
+  bool peekUnsent(EventRecord& out) const;
+  void popUnsent();
+
+  uint32_t count() const { return _count; }      // seit dem Start erkannt
+  uint32_t dropped() const { return _dropped; }  // aus dem RAM-Ring verdrängt (nicht gesendet)
+  LogStore& log() { return _log; }
+
+  // JSON-Objekt eines Ereignisses (Länge, 0 bei Fehler)
+  static const size_t kMaxJSON = 192;
+  static size_t formatJSON(const EventRecord& e, char* out, size_t cap);
+
+private:
+  struct RuleState {
+    bool armed = false;      // Rising/Falling: nächste Überschreitung meldet
+    bool active = false;     // Rate: Änderung liegt gerade über der Schwelle
+    bool init = false;       // Zustand aus der ersten Abtastung übernommen
+    uint8_t level = 0xFF;    // PdLevel: gültige Stufe in V (0xFF = noch keine)
+    uint8_t candidate = 0xFF;
+    uint8_t stable = 0;
+  };
+
+  String _configPath;
+  EventConfig _config;
+  RuleState _state[EventConfig::kMaxRules];
+  LogStore _log;
+  uint16_t _pos = 0;          // nächste Ringposition im Sensor
+  bool _polling = false;
+  bool _havePrev = false;
+  float _prev[3] = {0, 0, 0}; // vorige Abtastung (V, mA, W) für Rate
+  float _periodS = 0.05f;     // Abtastabstand
+
+  EventRecord _unsent[kUnsent];
+  uint8_t _unsentHead = 0, _unsentCount = 0;
+  uint32_t _count = 0;
+  uint32_t _dropped = 0;
+
+  void loadConfig();
+  void resetState();
+  void check(const SensorINA219::RawSample& s, float v, float i, float p, uint32_t ms, uint32_t epoch);
+  void emit(uint8_t rule, const SensorINA219::RawSample& s, float i, float value,
+            uint8_t fromV, uint32_t ms, uint32_t epoch);
+  static uint8_t pdLevel(float v, float tol);
+};
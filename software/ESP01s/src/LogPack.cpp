@@ -0,0 +1,165 @@
+#include "LogPack.h"
+#include "LogStore.h"
+
+static uint32_t rd32(const uint8_t* p) {
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static uint16_t rd16(const uint8_t* p) {
+  uint16_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static void wr32(uint8_t* p, uint32_t v) { memcpy(p, &v, sizeof(v)); }
+static void wr16(uint8_t* p, uint16_t v) { memcpy(p, &v, sizeof(v)); }
+
+// zigzag: kleine Beträge beider Vorzeichen -> kleine vorzeichenlose Zahlen
+static uint32_t zz32(int32_t v) { return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31); }
+static uint16_t zz16(int16_t v) { return (uint16_t)(((uint16_t)v << 1) ^ (uint16_t)(v >> 15)); }
+static int32_t unzz(uint32_t v) { return (int32_t)((v >> 1) ^ (0u - (v & 1))); }
+
+// ---- LogPacker ----
+
+bool LogPacker::supports(uint8_t recordSize) {
+  return recordSize >= sizeof(uint32_t) && recordSize <= kMaxRecord && (recordSize % 2) == 0;
+}
+
+bool LogPacker::begin(uint8_t recordSize) {
+  if (!supports(recordSize)) return false;
+  _recSize = recordSize;
+  memset(_prev, 0, sizeof(_prev));
+  _prevDelta = 0;
+  _run = 0;
+  return true;
+}
+
+size_t LogPacker::putVarint(uint8_t* out, uint64_t v) {
+  size_t n = 0;
+  while (v >= 0x80) {
+    out[n++] = (uint8_t)(v | 0x80);
+    v >>= 7;
+  }
+  out[n++] = (uint8_t)v;
+  return n;
+}
+
+size_t LogPacker::add(const uint8_t* rec, uint8_t* out) {
+  // Differenzen modulo 2^32 bzw. 2^16: der Dekodierer rechnet genauso zurück
+  const uint32_t delta = rd32(rec) - rd32(_prev);
+  const int32_t dod = (int32_t)(delta - _prevDelta);
+  bool same = (dod == 0);
+  for (size_t k = sizeof(uint32_t); same && k < _recSize; k += 2) {
+    same = rd16(rec + k) == rd16(_prev + k);
+  }
+  if (same) {
+    _run++;
+    memcpy(_prev, rec, _recSize); // epoch läuft im gleichen Schritt weiter
+    return 0;
+  }
+
+  size_t n = finish(out);
+  n += putVarint(out + n, (uint64_t)zz32(dod) << 1);
+  for (size_t k = sizeof(uint32_t); k < _recSize; k += 2) {
+    n += putVarint(out + n, zz16((int16_t)(rd16(rec + k) - rd16(_prev + k))));
+  }
+  memcpy(_prev, rec, _recSize);
+  _prevDelta = delta;
+  return n;
+}
+
+size_t LogPacker::skip(uint8_t* out) {
+  const size_t n = finish(out);
+  return n + putVarint(out + n, 1);
+}
+
+size_t LogPacker::finish(uint8_t* out) {
+  if (_run == 0) return 0;
+  const size_t n = putVarint(out, ((uint64_t)_run << 1) | 1);
+  _run = 0;
+  return n;
+}
+
+// ---- LogUnpacker ----
+
+void LogUnpacker::begin(uint8_t recordSize, uint32_t records) {
+  _recSize = LogPacker::supports(recordSize) ? recordSize : 0;
+  _left = _recSize ? records : 0;
+  memset(_prev, 0, sizeof(_prev));
+  _prevDelta = 0;
+  _run = 0;
+  _pos = _len = 0;
+}
+
+bool LogUnpacker::getByte(File& f, uint8_t& b) {
+  if (_pos == _len) {
+    const size_t got = f.read(_buf, kBuf);
+    LogStore::io().reads++;
+    LogStore::io().bytesRead += got;
+    if (got == 0) return false;
+    _pos = 0;
+    _len = (uint8_t)got;
+  }
+  b = _buf[_pos++];
+  return true;
+}
+
+bool LogUnpacker::getVarint(File& f, uint64_t& v) {
+  v = 0;
+  uint8_t b;
+  for (unsigned shift = 0; shift < 64; shift += 7) {
+    if (!getByte(f, b)) return false;
+    v |= (uint64_t)(b & 0x7F) << shift;
+    if (!(b & 0x80)) return true;
+  }
+  return false; // kaputter Strom
+}
+
+// Nächsten Satz in _prev dekodieren; hole = leerer Platz, _prev unverändert
+bool LogUnpacker::next(File& f, bool& hole) {
+  hole = false;
+  if (_run == 0) {
+    uint64_t t;
+    if (!getVarint(f, t)) return false;
+    if (t == 1) {
+      hole = true;
+      return true;
+    }
+    if (t & 1) {
+      _run = (uint32_t)(t >> 1);
+    } else {
+      _prevDelta += (uint32_t)unzz((uint32_t)(t >> 1));
+      wr32(_prev, rd32(_prev) + _prevDelta);
+      for (size_t k = sizeof(uint32_t); k < _recSize; k += 2) {
+        uint64_t d;
+        if (!getVarint(f, d)) return false;
+        wr16(_prev + k, (uint16_t)(rd16(_prev + k) + unzz((uint32_t)d)));
+      }
+      return true;
+    }
+  }
+  // Wiederholung: nur die epoch läuft weiter
+  _run--;
+  wr32(_prev, rd32(_prev) + _prevDelta);
+  return true;
+}
+
+size_t LogUnpacker::read(File& f, uint8_t* out, size_t max, size_t& used) {
+  size_t n = 0;
+  used = 0;
+  bool hole;
+  while (used < max && _left) {
+    if (!next(f, hole)) {
+      _left = 0; // Rest unlesbar: Segment hier beenden
+      break;
+    }
+    used++;
+    _left--;
+    if (hole) continue;
+    if (out) memcpy(out + n * _recSize, _prev, _recSize);
+    n++;
+  }
+  return n;
+}
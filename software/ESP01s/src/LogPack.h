@@ -0,0 +1,81 @@
+#pragma once
+#include <Arduino.h>
+#include <FS.h>
+
+// Gepacktes Segmentformat (beim Rotieren versiegelte Dateien, little endian):
+//   LogFileHeader mit flags = LOG_FLAG_PACKED
+//   LogPackInfo (12 Byte)
+//   kodierte Sätze: je Satz ein Token, danach je 16-Bit-Wort ein Delta
+//
+// Token (varint): gerade = neuer Satz, Token/2 ist das zigzag-kodierte
+// Delta-of-Delta der epoch; ungerade = Token/2 Wiederholungen (Delta-of-Delta
+// 0 und alle Wort-Deltas 0, typisch für Leerlauf). Die Wörter nach der epoch
+// werden als zigzag-varint der Differenz (mod 2^16) zum Vorgängersatz
+// gespeichert; Startwert ist jeweils 0. Token 1 (0 Wiederholungen) ist ein
+// leerer Platz: beim Versiegeln verworfener Satz (CRC-Fehler), der seine
+// Satznummer behält, damit LogCursor-Positionen gültig bleiben.
+static const uint16_t LOG_FLAG_PACKED = 0x0001;
+
+struct __attribute__((packed)) LogPackInfo {
+  uint32_t records;     // Anzahl Sätze einschließlich leerer Plätze
+  uint32_t firstEpoch;  // wie LogSegment, damit der Index nichts dekodieren muss
+  uint32_t lastEpoch;
+};
+
+// Kodierer für einen Satzstrom fester Länge (epoch + 16-Bit-Wörter)
+class LogPacker {
+public:
+  // größte packbare Satzlänge (Vorgängersatz liegt im RAM)
+  static const size_t kMaxRecord = 32;
+  // obere Grenze für die Ausgabe eines add()/finish()-Aufrufs
+  static const size_t kMaxOut = 5 + 5 + 3 * (kMaxRecord - 4) / 2;
+
+  // false = Satzlänge nicht packbar (zu lang oder kein ganzes Wortraster)
+  static bool supports(uint8_t recordSize);
+
+  bool begin(uint8_t recordSize);
+  // Kodiert einen Satz nach out (höchstens kMaxOut Byte); 0 = in Wiederholung aufgegangen
+  size_t add(const uint8_t* rec, uint8_t* out);
+  // Leerer Platz statt eines Satzes (höchstens kMaxOut Byte); der nächste
+  // Satz wird weiter gegen den letzten gültigen kodiert
+  size_t skip(uint8_t* out);
+  // Schreibt eine offene Wiederholung aus
+  size_t finish(uint8_t* out);
+
+private:
+  uint8_t  _recSize = 0;
+  uint8_t  _prev[kMaxRecord];
+  uint32_t _prevDelta = 0;
+  uint32_t _run = 0;
+
+  static size_t putVarint(uint8_t* out, uint64_t v);
+};
+
+// Streaming-Dekodierer: liest die kodierten Sätze blockweise aus der Datei
+// (kleiner Lesepuffer) und liefert sie wieder im Klartext-Format
+class LogUnpacker {
+public:
+  // f steht hinter LogPackInfo
+  void begin(uint8_t recordSize, uint32_t records);
+  // Liest bis zu max Satzplätze; used = verbrauchte Plätze (0 = Ende oder
+  // Fehler), Rückgabe = Sätze in out ohne leere Plätze (out = nullptr: nur
+  // überspringen)
+  size_t read(File& f, uint8_t* out, size_t max, size_t& used);
+  uint32_t remaining() const { return _left; }
+
+private:
+  static const size_t kBuf = 64;
+
+  uint8_t  _buf[kBuf];
+  uint8_t  _pos = 0;
+  uint8_t  _len = 0;
+  uint8_t  _recSize = 0;
+  uint8_t  _prev[LogPacker::kMaxRecord];
+  uint32_t _prevDelta = 0;
+  uint32_t _run = 0;   // noch auszugebende Wiederholungen
+  uint32_t _left = 0;  // noch nicht gelieferte Sätze
+
+  bool getByte(File& f, uint8_t& b);
+  bool getVarint(File& f, uint64_t& v);
+  bool next(File& f, bool& hole);
+};
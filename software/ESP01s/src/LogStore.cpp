@@ -0,0 +1,730 @@
+#include "LogStore.h"
+
+static String joinPath(const String& dir, const String& file) {
+  if (dir.endsWith("/")) return dir + file;
+  return dir + "/" + file;
+}
+
+bool LogStore::ensureDir() const {
+  if (LittleFS.exists(_dir)) return true;
+  return LittleFS.mkdir(_dir);
+}
+
+bool LogStore::parseIndex(const String& name, const String& prefix, const String& ext, int& out) {
+  if (!name.startsWith(prefix) || !name.endsWith(ext)) return false;
+  const int start = prefix.length();
+  const int end   = name.length() - ext.length(); // ext ist bereits String
+  if (end - start != 4) return false;             // genau 4 Ziffern
+  for (int i = start; i < end; ++i) {
+    if (name[i] < '0' || name[i] > '9') return false;
+  }
+  out = name.substring(start, end).toInt();
+  return true;
+}
+
+String LogStore::makeName(const String& prefix, int index, const String& ext) {
+  char buf[16];
+  snprintf(buf, sizeof(buf), "%04d", index & 0xFFFF);
+  return prefix + String(buf) + ext;
+}
+
+uint8_t LogStore::crc8(const uint8_t* p, size_t len) {
+  // Start 0xFF: ein genullter oder gelöschter (0xFF) Bereich besteht die Prüfung nicht
+  uint8_t crc = 0xFF;
+  while (len--) {
+    crc ^= *p++;
+    for (uint8_t b = 0; b < 8; ++b) crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+  }
+  return crc;
+}
+
+uint32_t LogStore::epochOf(const uint8_t* rec) {
+  uint32_t e;
+  memcpy(&e, rec, sizeof(e)); // Sätze sind gepackt, Puffer nicht ausgerichtet
+  return e;
+}
+
+String LogStore::segmentPath(size_t i) const {
+  return joinPath(_dir, makeName(_prefix, _segments[i].index, _ext));
+}
+
+uint32_t LogStore::segmentRecords(size_t i) const {
+  const LogSegment& seg = _segments[i];
+  if (seg.packed) return seg.records;
+  if (!seg.stride) return 0;
+  return seg.size > sizeof(LogFileHeader) ? (seg.size - sizeof(LogFileHeader)) / seg.stride : 0;
+}
+
+uint32_t LogStore::totalBytes() const {
+  uint32_t sum = 0;
+  for (const LogSegment& seg : _segments) sum += seg.size;
+  return sum;
+}
+
+uint32_t LogStore::allocatedBytes() const {
+  uint32_t used = 0;
+  for (const LogSegment& seg : _segments) used += blockAlign(seg.size);
+  return used;
+}
+
+uint32_t LogStore::firstEpoch() const {
+  for (const LogSegment& seg : _segments) {
+    if (seg.firstEpoch) return seg.firstEpoch;
+  }
+  return 0;
+}
+
+uint32_t LogStore::lastEpoch() const {
+  uint32_t last = 0;
+  for (const LogSegment& seg : _segments) {
+    if (seg.lastEpoch > last) last = seg.lastEpoch;
+  }
+  return last;
+}
+
+int LogStore::findSegment(const String& path) const {
+  for (size_t i = 0; i < _segments.size(); ++i) {
+    if (segmentPath(i) == path) return (int)i;
+  }
+  return -1;
+}
+
+size_t LogStore::lowerSegment(int index) const {
+  size_t i = 0;
+  while (i < _segments.size() && _segments[i].index < index) i++;
+  return i;
+}
+
+bool LogStore::findFirst(uint32_t minEpoch, LogCursor& out) {
+  flush(); // gepufferte Sätze müssen in der Datei stehen
+  out = LogCursor();
+  if (_segments.empty()) return false;
+  if (minEpoch == 0) return true;
+
+  // ganze Segmente überspringen, die vollständig vor dem Fenster liegen
+  size_t seg = 0;
+  while (seg < _segments.size() && _segments[seg].lastEpoch < minEpoch) seg++;
+  if (seg == _segments.size()) return false;
+  out.seg = _segments[seg].index;
+  if (_segments[seg].firstEpoch >= minEpoch) return true;
+
+  if (_segments[seg].packed) {
+    // gepackt gibt es keine festen Satzpositionen: linear dekodieren; die
+    // Satznummer kommt vom Reader (leere Plätze zählen mit)
+    LogReader rd(*this, out, out.seg);
+    uint8_t rec[LogPacker::kMaxRecord];
+    while (rd.read(rec, 1) == 1) {
+      if (epochOf(rec) >= minEpoch) {
+        out.rec = rd.cursor().rec - 1;
+        break;
+      }
+      out.rec = rd.cursor().rec;
+    }
+    rd.close();
+    return true;
+  }
+
+  File f = LittleFS.open(segmentPath(seg), "r");
+  if (!f) return true; // Aufrufer filtert ohnehin satzweise
+  io().opens++;
+
+  // lower_bound über die Sätze; epoch 0 (nicht synchron) zählt als "zu alt"
+  const uint8_t stride = _segments[seg].stride;
+  uint32_t lo = 0, hi = segmentRecords(seg);
+  uint32_t epoch;
+  while (lo < hi) {
+    const uint32_t mid = lo + (hi - lo) / 2;
+    if (!f.seek(recordOffset(mid, stride)) || f.read((uint8_t*)&epoch, sizeof(epoch)) != sizeof(epoch)) break;
+    io().reads++;
+    io().bytesRead += sizeof(epoch);
+    if (epoch < minEpoch) lo = mid + 1;
+    else hi = mid;
+  }
+  f.close();
+  out.rec = lo;
+  return true;
+}
+
+LogCursor LogStore::endCursor() const {
+  LogCursor c;
+  if (_segments.empty()) return c;
+  c.seg = _segments.back().index;
+  c.rec = segmentRecords(_segments.size() - 1);
+  return c;
+}
+
+bool LogStore::contains(const LogCursor& pos) const {
+  if (pos.seg < 0) return false;
+  const size_t i = lowerSegment(pos.seg);
+  return i < _segments.size() && _segments[i].index == pos.seg && pos.rec <= segmentRecords(i);
+}
+
+LogIoStats& LogStore::io() {
+  static LogIoStats stats;
+  return stats;
+}
+
+bool LogStore::readHeader(File& f, uint16_t* flags, uint8_t* stride) const {
+  LogFileHeader h;
+  if (f.read((uint8_t*)&h, sizeof(h)) != sizeof(h)) return false;
+  // unbekannte Flags, oder gepackt bei einem Aufrufer, der das nicht erwartet
+  if (h.flags & ~(flags ? LOG_FLAG_PACKED : 0)) return false;
+  if (memcmp(h.magic, LOG_MAGIC, sizeof(h.magic)) != 0 || h.recordSize != _recSize) return false;
+  if (h.version != LOG_FORMAT_VERSION && h.version != LOG_FORMAT_PLAIN) return false;
+  if (flags) *flags = h.flags;
+  if (stride) *stride = (h.version == LOG_FORMAT_PLAIN) ? _recSize : _recSize + 1;
+  return true;
+}
+
+// Erster/jüngster Satz mit gültiger Zeit; liest nur Anfang und Ende der Datei
+// bzw. bei gepackten Dateien die mitgespeicherten Werte
+void LogStore::readEpochRange(File& f, LogSegment& seg) const {
+  seg.firstEpoch = seg.lastEpoch = 0;
+  seg.stride = 0;
+  uint16_t flags;
+  uint8_t stride;
+  if (!readHeader(f, &flags, &stride)) return;
+  seg.stride = stride;
+  if (flags & LOG_FLAG_PACKED) {
+    seg.packed = true;
+    LogPackInfo info;
+    if (f.read((uint8_t*)&info, sizeof(info)) != sizeof(info)) return;
+    seg.records    = info.records;
+    seg.firstEpoch = info.firstEpoch;
+    seg.lastEpoch  = info.lastEpoch;
+    return;
+  }
+
+  // beschädigte Sätze (CRC) zählen wie Sätze ohne Zeit
+  const size_t n = (seg.size - sizeof(LogFileHeader)) / stride;
+  uint8_t rec[kMaxRecordSize + 1];
+  auto epochAt = [&](size_t i) -> uint32_t {
+    if (!f.seek(recordOffset(i, stride)) || f.read(rec, stride) != stride) return 0;
+    if (stride > _recSize && crc8(rec, _recSize) != rec[_recSize]) return 0;
+    return epochOf(rec);
+  };
+  size_t first = 0;
+  for (; first < n; ++first) {
+    if ((seg.firstEpoch = epochAt(first)) != 0) break;
+  }
+  for (size_t i = n; i > first; --i) {
+    if ((seg.lastEpoch = epochAt(i - 1)) != 0) break;
+  }
+}
+
+// Unvollständiges oder beschädigtes Ende der jüngsten Datei abschneiden.
+// Nur der letzte Flush kann betroffen sein, geprüft werden daher höchstens so
+// viele Sätze, wie der Schreibpuffer fasst – kein Durchlauf über die Datei.
+bool LogStore::recoverTail(LogSegment& seg, const String& path) {
+  if (seg.packed || !seg.stride || seg.size < sizeof(LogFileHeader)) return true;
+  const uint8_t stride = seg.stride;
+  uint32_t n = (seg.size - sizeof(LogFileHeader)) / stride;
+  File f = LittleFS.open(path, "r+");
+  if (!f) {
+    // Index wenigstens auf die letzte Satzgrenze, der Rest bleibt der Aufrufer
+    seg.size = recordOffset(n, stride);
+    return false;
+  }
+  io().opens++;
+  if (stride > _recSize) {
+    uint8_t rec[kMaxRecordSize + 1];
+    const uint32_t limit = n > bufferCapacity() ? n - bufferCapacity() : 0;
+    while (n > limit) {
+      if (!f.seek(recordOffset(n - 1, stride)) || f.read(rec, stride) != stride) break;
+      if (crc8(rec, _recSize) == rec[_recSize]) break;
+      n--;
+    }
+  }
+  const uint32_t size = recordOffset(n, stride);
+  bool ok = true;
+  if (size != seg.size) {
+    ok = f.truncate(size);
+    Serial.printf("[LOG] %s: %u Byte unvollständiges Ende %s\n", path.c_str(),
+                  (unsigned)(seg.size - size), ok ? "abgeschnitten" : "nicht abschneidbar");
+    io().recovered += seg.size - size;
+    seg.size = size;
+    f.seek(0);
+    readEpochRange(f, seg); // Zeitspanne ohne die abgeschnittenen Sätze
+  }
+  f.close();
+  return ok;
+}
+
+void LogStore::buildIndex() {
+  _segments.clear();
+
+  Dir dir = LittleFS.openDir(_dir);
+  while (dir.next()) {
+    yield(); // WDT füttern während Dir-Iteration
+    LogSegment seg = {};
+    if (!parseIndex(dir.fileName(), _prefix, _ext, seg.index)) continue;
+
+    // nach Index einsortieren (Verzeichnisreihenfolge ist nicht garantiert)
+    size_t pos = _segments.size();
+    while (pos > 0 && _segments[pos - 1].index > seg.index) pos--;
+    _segments.insert(_segments.begin() + pos, seg);
+  }
+
+  for (size_t i = 0; i < _segments.size(); ++i) {
+    LogSegment& seg = _segments[i];
+    File f = LittleFS.open(segmentPath(i), "r");
+    seg.size = f ? f.size() : 0;
+    if (f) {
+      readEpochRange(f, seg);
+      f.close();
+    }
+    yield(); // WDT nach File-Open/Close
+  }
+}
+
+bool LogStore::createNewFile(int index) {
+  // Dateikopf erst in eine Hilfsdatei, dann umbenennen: die neue Datei ist
+  // entweder vollständig da oder gar nicht
+  const String path = joinPath(_dir, makeName(_prefix, index, _ext));
+  const String tmp  = tempPath("new");
+  File f = LittleFS.open(tmp, "w");
+  if (!f) return false;
+  io().opens++;
+  // Versionierter Dateikopf, danach nur noch Sätze fester Länge
+  LogFileHeader h;
+  memcpy(h.magic, LOG_MAGIC, sizeof(h.magic));
+  h.version    = LOG_FORMAT_VERSION;
+  h.recordSize = _recSize;
+  h.flags      = 0;
+  const size_t w = f.write((const uint8_t*)&h, sizeof(h));
+  f.close();
+  io().writes++;
+  io().bytesWritten += w;
+  if (w != sizeof(h) || !LittleFS.rename(tmp, path)) {
+    LittleFS.remove(tmp);
+    return false;
+  }
+  _currentPath = path;
+  _misaligned = false;
+  _segments.push_back(LogSegment{ index, (uint32_t)sizeof(h), 0, 0, false, stride(), 0 });
+  return true;
+}
+
+void LogStore::setFlushPolicy(size_t records, unsigned long maxAgeMs) {
+  _flushRecords = records ? records : 1; // obere Grenze: Puffergröße, siehe begin()
+  _flushMs      = maxAgeMs;
+}
+
+bool LogStore::begin(const char* dirPath, const char* prefix, const char* ext, uint8_t recordSize,
+                     size_t maxFileSize, size_t maxFiles) {
+  _dir = dirPath;
+  _prefix = prefix;
+  _ext = ext;
+  _recSize = recordSize;
+  _maxFileSize = maxFileSize;
+  _maxFiles = maxFiles;
+  _bufCount = 0;
+  _misaligned = false;
+  FSInfo fsi;
+  _blockSize = (LittleFS.info(fsi) && fsi.blockSize) ? fsi.blockSize : 4096;
+  _segments.clear();
+
+  if (_recSize < sizeof(uint32_t) || _recSize > kMaxRecordSize || bufferCapacity() == 0) return false;
+  _flushRecords = constrain(_flushRecords, (size_t)1, bufferCapacity());
+  if (!ensureDir()) return false;
+
+  // Reste abgebrochener Rotationen bzw. Packvorgänge
+  LittleFS.remove(tempPath("new"));
+  LittleFS.remove(tempPath("pack"));
+
+  buildIndex();
+
+  if (!_segments.empty()) {
+    // Ende der jüngsten Datei prüfen; eine leere oder unlesbare Datei bzw. eine
+    // ohne Prüfsummen (ältere Firmware) wird nicht fortgeschrieben
+    LogSegment& last = _segments.back();
+    const String path = segmentPath(_segments.size() - 1);
+    if (last.size < sizeof(LogFileHeader) || !last.stride) {
+      LittleFS.remove(path);
+      _segments.pop_back();
+      io().removes++;
+    } else if (!recoverTail(last, path)) {
+      // Rest ließ sich nicht abschneiden: erster Flush versucht es erneut
+      // oder beginnt eine neue Datei, statt dahinter weiterzuschreiben
+      _misaligned = true;
+    }
+  }
+
+  if (_pack) {
+    // ungepackte ältere Segmente (Abbruch beim Rotieren oder ältere Firmware) versiegeln
+    for (size_t i = 0; i + 1 < _segments.size(); ++i) {
+      if (!_segments[i].packed) packSegment(i);
+      yield();
+    }
+  }
+
+  // gepackt = versiegelt (Abbruch zwischen Packen und neuer Datei): nie fortschreiben
+  if (_segments.empty() || _segments.back().packed || _segments.back().stride != stride()) {
+    const int next = _segments.empty() ? 0 : _segments.back().index + 1;
+    if (!createNewFile(next)) return false;
+  }
+  _currentPath = segmentPath(_segments.size() - 1);
+
+  // Abbruch zwischen neuer Datei und Löschen der ältesten: jetzt nachholen
+  while (_segments.size() > 1 && overBudget()) removeOldest();
+  return true;
+}
+
+bool LogStore::append(const void* rec) {
+  if (_segments.empty()) return false; // begin() fehlgeschlagen
+  if (_bufCount >= bufferCapacity() && !flush()) return false; // Puffer voll, Flash nicht beschreibbar
+
+  uint8_t* p = _buf + _bufCount * stride();
+  memcpy(p, rec, _recSize);
+  p[_recSize] = crc8(p, _recSize);
+  if (_bufCount++ == 0) _bufSince = millis();
+
+  // Index der aktuellen Datei mitführen
+  LogSegment& cur = _segments.back();
+  const uint32_t epoch = epochOf((const uint8_t*)rec);
+  if (epoch) {
+    if (!cur.firstEpoch) cur.firstEpoch = epoch;
+    if (epoch > cur.lastEpoch) cur.lastEpoch = epoch;
+  }
+
+  // Rotation anhand der logischen Größe (Datei + Puffer), ohne die Datei erneut zu öffnen
+  if (cur.size + _bufCount * stride() >= _maxFileSize) return rotateIfNeeded();
+  if (_bufCount >= _flushRecords) return flush();
+  return true;
+}
+
+void LogStore::loop() {
+  if (_bufCount && millis() - _bufSince >= _flushMs) flush();
+}
+
+bool LogStore::flush() {
+  if (_bufCount == 0) return true;
+  if (_segments.empty()) return false;
+
+  bool full = false;
+  if (writeBuffer(full)) return true;
+  // Dateisystem voll: wie bei createNewFile() das älteste Segment opfern und
+  // erneut schreiben, sonst stünde der Logger bis zur nächsten Rotation still
+  if (!full || _segments.size() < 2) return false;
+  removeOldest();
+  return writeBuffer(full);
+}
+
+bool LogStore::writeBuffer(bool& full) {
+  const unsigned long t0 = micros();
+  File f = LittleFS.open(_currentPath, "a");
+  if (!f) return false;
+  if (_misaligned) {
+    // halber Satz vom letzten Mal steht noch am Ende: erneut abschneiden,
+    // sonst nicht dahinter weiterschreiben, sondern eine neue Datei beginnen
+    if (!f.truncate(_segments.back().size)) {
+      f.close();
+      if (!createNewFile(_segments.back().index + 1)) return false;
+      f = LittleFS.open(_currentPath, "a");
+      if (!f) return false;
+    }
+    _misaligned = false;
+  }
+  const size_t len = _bufCount * stride();
+  size_t w = f.write(_buf, len);
+  if (w % stride()) {
+    // halben Satz (z.B. Dateisystem voll) sofort wieder entfernen, sonst
+    // stünden alle folgenden Sätze verschoben
+    const uint32_t keep = _segments.back().size + w / stride() * stride();
+    if (f.truncate(keep)) w = w / stride() * stride();
+    else _misaligned = true;
+  }
+  f.close();
+
+  LogIoStats& st = io();
+  const uint32_t us = micros() - t0;
+  st.opens++;
+  st.writes++;
+  st.bytesWritten += w;
+  st.flushes++;
+  st.flushSumUs += us;
+  if (us > st.flushMaxUs) st.flushMaxUs = us;
+
+  // nur vollständig geschriebene Sätze zählen; Rest bleibt im Puffer
+  const size_t done = w / stride();
+  _segments.back().size += done * stride();
+  if (done < _bufCount) {
+    memmove(_buf, _buf + done * stride(), (_bufCount - done) * stride());
+    _bufCount -= done;
+    full = true; // kurz geschrieben: zu wenig Platz
+    return false;
+  }
+  _bufCount = 0;
+  return true;
+}
+
+bool LogStore::rotateIfNeeded() {
+  if (_segments.back().size + _bufCount * stride() < _maxFileSize) return true;
+  if (!flush()) return false;
+
+  const int nextIdx = _segments.back().index + 1;
+
+  // volle Datei versiegeln; schlägt das fehl, bleibt sie ungepackt lesbar
+  if (_pack) packSegment(_segments.size() - 1);
+
+  // erst die neue Datei anlegen, dann die ältesten löschen: ein Neustart
+  // dazwischen findet höchstens eine Datei zu viel, begin() räumt sie ab
+  bool ok = createNewFile(nextIdx);
+  if (!ok && _segments.size() > 1) {
+    removeOldest(); // Dateisystem voll: Platz schaffen und erneut versuchen
+    ok = createNewFile(nextIdx);
+  }
+  if (!ok) return false;
+  io().rotations++;
+
+  while (_segments.size() > 1 && overBudget()) removeOldest();
+  return true;
+}
+
+// Zu viele Segmente? Ohne Packen zählt die Dateianzahl, mit Packen darüber
+// hinaus das Byte-Budget (in ganzen FS-Blöcken, die aktuelle Datei mit voller
+// Größe gerechnet) und eine Obergrenze für den RAM-Index
+bool LogStore::overBudget() const {
+  if (_segments.size() <= _maxFiles) return false;
+  if (!_pack) return true;
+  if (_segments.size() > _maxFiles * kPackedFilesFactor) return true;
+  const uint32_t older = allocatedBytes() - blockAlign(_segments.back().size);
+  return older + _maxFileSize > _maxFiles * _maxFileSize;
+}
+
+void LogStore::removeOldest() {
+  LittleFS.remove(segmentPath(0));
+  _segments.erase(_segments.begin());
+  io().removes++;
+}
+
+void LogStore::setLimits(size_t maxFileSize, size_t maxFiles) {
+  _maxFileSize = maxFileSize;
+  _maxFiles = maxFiles;
+  // wie bei der Rotation, die aktuelle Datei bleibt in jedem Fall
+  while (_segments.size() > 1 && overBudget()) removeOldest();
+}
+
+// Hilfsdateien "<prefix>new.tmp" (Rotation) und "<prefix>pack.tmp" (Packen)
+String LogStore::tempPath(const char* what) const {
+  return joinPath(_dir, _prefix + what + ".tmp");
+}
+
+// Schreibt Segment i gepackt in eine Temp-Datei und ersetzt das Original per
+// rename (atomar: bei Stromausfall bleibt die alte oder die neue Datei). Liest
+// über den – nach flush() leeren – Schreibpuffer, braucht also kaum RAM.
+// Ein noch offener LogReader liest die alte Fassung zu Ende.
+bool LogStore::packSegment(size_t i) {
+  LogSegment& seg = _segments[i];
+  const uint32_t n = segmentRecords(i);
+  LogPacker pk;
+  if (seg.packed || !seg.stride || n == 0 || _bufCount || !pk.begin(_recSize)) return false;
+
+  const String path = segmentPath(i);
+  const String tmp  = tempPath("pack");
+  File in = LittleFS.open(path, "r");
+  if (!in) return false;
+  File out = LittleFS.open(tmp, "w");
+  if (!out) { in.close(); return false; }
+  io().opens += 2;
+
+  LogFileHeader h;
+  memcpy(h.magic, LOG_MAGIC, sizeof(h.magic));
+  h.version    = LOG_FORMAT_VERSION;
+  h.recordSize = _recSize;
+  h.flags      = LOG_FLAG_PACKED;
+  // Satzanzahl steht erst am Ende fest
+  LogPackInfo info = { 0, seg.firstEpoch, seg.lastEpoch };
+  size_t size = out.write((const uint8_t*)&h, sizeof(h));
+  size += out.write((const uint8_t*)&info, sizeof(info));
+  const uint8_t st = seg.stride;
+  bool ok = readHeader(in) && size == sizeof(h) + sizeof(info);
+
+  uint8_t enc[128];
+  size_t fill = 0;
+  auto drain = [&]() {
+    const size_t w = out.write(enc, fill);
+    io().writes++;
+    io().bytesWritten += w;
+    size += w;
+    const bool done = (w == fill);
+    fill = 0;
+    return done;
+  };
+
+  uint32_t left = n;
+  while (ok && left) {
+    const size_t want = min((size_t)left, bufferCapacity());
+    const size_t got = in.read(_buf, want * st);
+    io().reads++;
+    io().bytesRead += got;
+    if (got != want * st) { ok = false; break; }
+    for (size_t k = 0; ok && k < want; ++k) {
+      const uint8_t* rec = _buf + k * st;
+      if (st > _recSize && crc8(rec, _recSize) != rec[_recSize]) {
+        // beschädigt: Platz freihalten, sonst verschöben sich die Satznummern
+        // gegenüber Cursorn, die Clients noch halten
+        io().crcErrors++;
+        fill += pk.skip(enc + fill);
+      } else {
+        fill += pk.add(rec, enc + fill);
+      }
+      info.records++;
+      if (fill + LogPacker::kMaxOut > sizeof(enc)) ok = drain();
+    }
+    left -= want;
+    if (size >= seg.size) ok = false; // lohnt sich nicht
+    yield();
+  }
+  if (ok) {
+    fill += pk.finish(enc + fill);
+    ok = drain() && size < seg.size && info.records > 0;
+  }
+  if (ok) {
+    ok = out.seek(sizeof(h)) && out.write((const uint8_t*)&info, sizeof(info)) == sizeof(info);
+  }
+  in.close();
+  out.close();
+
+  if (!ok || !LittleFS.rename(tmp, path)) {
+    LittleFS.remove(tmp);
+    return false;
+  }
+  seg.packed  = true;
+  seg.records = info.records;
+  seg.size    = size;
+  return true;
+}
+
+bool LogStore::clearAll() {
+  if (!ensureDir()) return false;
+
+  // eigene Dateien löschen (Index neu aufbauen, falls begin() fehlgeschlagen war)
+  buildIndex();
+  for (size_t i = 0; i < _segments.size(); ++i) {
+    LittleFS.remove(segmentPath(i));
+    yield();
+  }
+
+  // gepufferte Sätze gehören zu den gelöschten Daten und werden verworfen
+  _segments.clear();
+  _currentPath  = String();
+  _bufCount     = 0;
+
+  // frisch initialisieren – begin legt "<prefix>0000<ext>" an und schreibt den Dateikopf
+  return begin(_dir.c_str(), _prefix.c_str(), _ext.c_str(), _recSize, _maxFileSize, _maxFiles);
+}
+
+bool LogReader::openCurrent() {
+  const size_t pos = _store->lowerSegment(_cur.seg);
+  if (pos >= _store->segmentCount()) return false;
+  const int index = _store->segment(pos).index;
+  if (index > _lastSeg) return false;
+  if (index != _cur.seg) {
+    // Datei wurde rotiert oder Start "ab Anfang": mit der nächsten vorhandenen weiter
+    _cur.seg = index;
+    _cur.rec = 0;
+  }
+
+  _f = LittleFS.open(_store->segmentPath(pos), "r");
+  if (!_f) return false;
+  LogStore::io().opens++;
+  uint16_t flags;
+  if (!_store->readHeader(_f, &flags, &_stride)) {
+    _f.close();
+    return false;
+  }
+  _packed = (flags & LOG_FLAG_PACKED) != 0;
+  if (!_packed) {
+    if (_f.seek(LogStore::recordOffset(_cur.rec, _stride))) return true;
+    _f.close();
+    return false;
+  }
+
+  // gepackt: ab Satzanfang dekodieren und bis zur Leseposition überspringen
+  LogPackInfo info;
+  if (_f.read((uint8_t*)&info, sizeof(info)) != sizeof(info)) {
+    _f.close();
+    return false;
+  }
+  _unpack.begin(_store->recordSize(), info.records);
+  uint32_t skip = min(_cur.rec, info.records);
+  while (skip) {
+    size_t used;
+    _unpack.read(_f, nullptr, skip, used);
+    if (used == 0) break;
+    skip -= used;
+  }
+  return true;
+}
+
+// Sätze samt CRC direkt nach out lesen und dort zusammenschieben (passt nicht
+// einmal einer hinein, über einen Satzpuffer). used = verbrauchte Sätze der
+// Datei einschließlich verworfener, Rückgabe = gültige Sätze in out
+size_t LogReader::readPlain(uint8_t* out, size_t max, size_t& used) {
+  const size_t rs = _store->recordSize();
+  uint8_t one[LogStore::kMaxRecordSize + 1];
+  uint8_t* dst = out;
+  size_t k = max * rs / _stride;
+  if (k == 0) {
+    k = 1;
+    dst = one;
+  }
+  const size_t got = _f.read(dst, k * _stride);
+  LogStore::io().reads++;
+  LogStore::io().bytesRead += got;
+  used = got / _stride;
+  if (got % _stride) _f.seek(LogStore::recordOffset(_cur.rec + used, _stride)); // halben Satz nicht überspringen
+  if (_stride == rs) return used; // Version 1, ohne Prüfsumme
+
+  size_t n = 0;
+  for (size_t j = 0; j < used; ++j) {
+    const uint8_t* p = dst + j * _stride;
+    if (LogStore::crc8(p, rs) != p[rs]) {
+      LogStore::io().crcErrors++;
+      continue;
+    }
+    memmove(out + n * rs, p, rs);
+    n++;
+  }
+  return n;
+}
+
+size_t LogReader::read(void* out, size_t max) {
+  if (!_store) return 0;
+  while (true) {
+    if (!_f && !openCurrent()) {
+      // unlesbare Datei überspringen, sofern es eine jüngere gibt
+      const size_t next = _store->lowerSegment(_cur.seg + 1);
+      if (next >= _store->segmentCount() || _store->segment(next).index > _lastSeg) return 0;
+      _cur.seg = _store->segment(next).index;
+      _cur.rec = 0;
+      continue;
+    }
+
+    // Satzgrenze in der letzten Datei
+    if (_cur.seg == _lastSeg && _endRec != 0xFFFFFFFF) {
+      if (_cur.rec >= _endRec) return 0;
+      max = min(max, (size_t)(_endRec - _cur.rec));
+    }
+
+    size_t n, used;
+    if (_packed) {
+      n = _unpack.read(_f, (uint8_t*)out, max, used);
+    } else {
+      n = readPlain((uint8_t*)out, max, used);
+    }
+    if (used) {
+      _cur.rec += used;
+      if (n) return n;
+      continue; // nur beschädigte Sätze: weiterlesen
+    }
+
+    // Datei zu Ende: nur weiter, wenn es eine jüngere gibt (sonst bleibt der Cursor hier)
+    _f.close();
+    const size_t next = _store->lowerSegment(_cur.seg + 1);
+    if (next >= _store->segmentCount() || _store->segment(next).index > _lastSeg) return 0;
+    _cur.seg = _store->segment(next).index;
+    _cur.rec = 0;
+  }
+}
@@ -0,0 +1,226 @@
+#pragma once
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <vector>
+#include "LogPack.h"
+
+// Binäres Logformat (little endian):
+//   Dateikopf (8 Byte) + Sätze fester Länge; jeder Satz beginnt mit uint32_t epoch
+//   und endet ab Version 2 mit einer CRC-8 über den Satz (Version 1: ohne),
+//   oder, mit LOG_FLAG_PACKED, ein versiegeltes Segment im Format aus LogPack.h
+static const char    LOG_MAGIC[4]       = { 'P', 'D', 'L', 'G' };
+static const uint8_t LOG_FORMAT_VERSION = 2;
+static const uint8_t LOG_FORMAT_PLAIN   = 1;  // ohne Prüfsumme (ältere Dateien, Download ?format=bin)
+
+struct __attribute__((packed)) LogFileHeader {
+  char     magic[4];    // "PDLG"
+  uint8_t  version;     // LOG_FORMAT_VERSION oder LOG_FORMAT_PLAIN
+  uint8_t  recordSize;  // Satzlänge der Datei (unterscheidet Roh- und Verdichtungsdateien)
+  uint16_t flags;       // LOG_FLAG_PACKED, sonst 0
+};
+
+// Eintrag im RAM-Index der Logdateien (Segmente)
+struct LogSegment {
+  int      index;       // laufende Nummer (log_####)
+  uint32_t size;        // Dateigröße in Byte (inkl. Kopf, ohne Schreibpuffer)
+  uint32_t firstEpoch;  // erster Satz mit gültiger Zeit (0 = keiner)
+  uint32_t lastEpoch;   // jüngster Satz mit gültiger Zeit (0 = keiner)
+  bool     packed;      // versiegelt und gepackt (nur ältere Segmente, nie die aktuelle Datei)
+  uint8_t  stride;      // Byte je Satz in der Datei (Satz + ggf. CRC), 0 = Dateikopf ungültig
+  uint32_t records;     // Satzanzahl gepackter Segmente (sonst aus size berechnet)
+};
+
+// Leseposition im Log: Dateinummer (log_####) + Satznummer. Bleibt über
+// Rotationen gültig; ist die Datei inzwischen gelöscht, geht es mit der
+// ältesten vorhandenen weiter.
+struct LogCursor {
+  int      seg = -1;  // Dateinummer, -1 = ab der ältesten Datei
+  uint32_t rec = 0;   // Satznummer in der Datei
+};
+
+// Flash-Zugriffe aller LogStores und LogReader seit dem Start (für /api/metrics)
+struct LogIoStats {
+  uint32_t opens = 0;
+  uint32_t reads = 0;
+  uint32_t bytesRead = 0;
+  uint32_t writes = 0;
+  uint32_t bytesWritten = 0;
+  uint32_t rotations = 0;
+  uint32_t removes = 0;
+  uint32_t flushes = 0;
+  uint32_t flushMaxUs = 0;    // längster Flush (open + write + close)
+  uint64_t flushSumUs = 0;
+  uint32_t crcErrors = 0;     // beim Lesen verworfene Sätze
+  uint32_t recovered = 0;     // beim Start abgeschnittene Byte (unvollständiges Dateiende)
+};
+
+// Rotierender Satz von Logdateien mit Sätzen fester Länge (prefix####ext),
+// RAM-Index der Segmente und Schreibpuffer. Der Satzinhalt ist dem Speicher
+// egal – nur die ersten 4 Byte (epoch) werden für Index und Suche gelesen.
+//
+// Stromausfall: Jeder Satz trägt eine CRC-8, Leser verwerfen beschädigte
+// Sätze. begin() schneidet ein unvollständiges oder beschädigtes Ende der
+// jüngsten Datei ab (nur der letzte Flush kann betroffen sein). Neue Dateien
+// entstehen vollständig per Hilfsdatei + rename, und gelöscht wird erst,
+// wenn die neue Datei steht – ein Neustart findet immer einen gültigen Stand.
+class LogStore {
+public:
+  // größte Satzlänge (ohne CRC)
+  static const size_t kMaxRecordSize = 32;
+  // Größe des Schreibpuffers in Byte (obere Grenze für setFlushPolicy)
+  static const size_t kBufferBytes = 256;
+  // mit Packen höchstens maxFiles * kPackedFilesFactor Segmente im Index
+  static const size_t kPackedFilesFactor = 4;
+
+  // Schreibpuffer: Flush nach 'records' Sätzen oder spätestens nach 'maxAgeMs'
+  void setFlushPolicy(size_t records, unsigned long maxAgeMs);
+
+  // Volle Segmente beim Rotieren packen (vor begin() setzen). Die Aufbewahrung
+  // richtet sich dann nach dem Byte-Budget maxFiles * maxFileSize statt nach
+  // der Dateianzahl, gepackte Segmente halten also entsprechend länger.
+  void setPacking(bool on) { _pack = on; }
+
+  // Initialisiert den Speicher (Rotation): z.B. dir="/logs", prefix="log_", ext=".bin"
+  bool begin(const char* dirPath, const char* prefix, const char* ext, uint8_t recordSize,
+             size_t maxFileSize, size_t maxFiles);
+
+  // Neue Grenzen im Betrieb (z.B. nach Änderung des Flash-Budgets): gelten ab
+  // der nächsten Rotation, überzählige ältere Segmente werden sofort gelöscht
+  void setLimits(size_t maxFileSize, size_t maxFiles);
+  size_t maxFileSize() const { return _maxFileSize; }
+  size_t maxFiles() const { return _maxFiles; }
+
+  // Puffert einen Satz (recordSize Byte) im RAM, schreibt gemäß Flush-Policy und prüft ggf. Rotation
+  bool append(const void* rec);
+
+  // Zeitgesteuerter Flush (aus loop() aufrufen)
+  void loop();
+
+  // Schreibt gepufferte Sätze in die aktuelle Datei (vor jedem Lesezugriff aufrufen)
+  bool flush();
+
+  // Löscht die eigenen Dateien samt Schreibpuffer und startet frisch
+  bool clearAll();
+
+  bool ready() const { return !_segments.empty(); }
+  uint8_t recordSize() const { return _recSize; }
+
+  // Segment-Index (aufsteigend, 0 = älteste Datei, letzte = aktuelle Datei);
+  // wird in begin() einmal aufgebaut und danach nur im RAM gepflegt
+  size_t segmentCount() const { return _segments.size(); }
+  const LogSegment& segment(size_t i) const { return _segments[i]; }
+  String segmentPath(size_t i) const;
+  uint32_t segmentRecords(size_t i) const;
+  static uint32_t recordOffset(uint32_t rec, uint8_t stride) { return sizeof(LogFileHeader) + rec * stride; }
+  // Summe der Dateigrößen bzw. der davon belegten FS-Blöcke
+  uint32_t totalBytes() const;
+  uint32_t allocatedBytes() const;
+
+  // Ältester/jüngster Satz mit gültiger Zeit über alle Segmente (0 = keiner)
+  uint32_t firstEpoch() const;
+  uint32_t lastEpoch() const;
+
+  // Position im Index (-1 = nicht vorhanden) bzw. erste Datei mit Nummer >= index
+  int findSegment(const String& path) const;
+  size_t lowerSegment(int index) const;
+
+  // Erster Satz mit epoch >= minEpoch. Überspringt Segmente, deren jüngster Satz
+  // älter ist, und sucht im ersten passenden Segment binär (Sätze sind nach Zeit
+  // geordnet). false = nichts im Fenster.
+  bool findFirst(uint32_t minEpoch, LogCursor& out);
+
+  // Position hinter dem jüngsten geschriebenen Satz (vorher flush()); als Grenze
+  // für LogReader und als Fortsetzungspunkt für inkrementelle Abfragen
+  LogCursor endCursor() const;
+  // true = pos zeigt in eine vorhandene Datei und nicht hinter ihr Ende, es
+  // fehlen also keine Sätze zwischen pos und endCursor()
+  bool contains(const LogCursor& pos) const;
+
+  // Aktueller Dateipfad
+  String currentFilePath() const { return _currentPath; }
+
+  // Liest und prüft den Dateikopf; danach steht f auf dem ersten Satz bzw.
+  // bei gepackten Dateien (flags & LOG_FLAG_PACKED) auf LogPackInfo.
+  // stride = Byte je Satz in der Datei
+  bool readHeader(File& f, uint16_t* flags = nullptr, uint8_t* stride = nullptr) const;
+
+  // Prüfsumme eines Satzes (CRC-8, Polynom 0x07, Start 0xFF)
+  static uint8_t crc8(const uint8_t* p, size_t len);
+
+  // Zähler über alle Instanzen
+  static LogIoStats& io();
+
+private:
+  String _dir;
+  String _prefix;
+  String _ext;
+  uint8_t _recSize = 0;
+  size_t _maxFileSize = 0;
+  size_t _maxFiles = 0;
+  bool _pack = false;
+  size_t _blockSize = 4096;
+  String _currentPath;
+  std::vector<LogSegment> _segments;
+
+  uint8_t _buf[kBufferBytes];
+  size_t _bufCount = 0;             // gepufferte Sätze
+  unsigned long _bufSince = 0;      // millis() des ältesten gepufferten Satzes
+  size_t _flushRecords = 1;
+  unsigned long _flushMs = 0;
+  bool _misaligned = false;         // halber Satz am Dateiende ließ sich nicht abschneiden
+
+  bool ensureDir() const;
+  void buildIndex();
+  void readEpochRange(File& f, LogSegment& seg) const;
+  static bool parseIndex(const String& name, const String& prefix, const String& ext, int& out);
+  static String makeName(const String& prefix, int index, const String& ext);
+  static uint32_t epochOf(const uint8_t* rec);
+  uint8_t stride() const { return _recSize + 1; }  // geschriebenes Format (Version 2)
+  uint32_t blockAlign(uint32_t bytes) const { return (bytes + _blockSize - 1) / _blockSize * _blockSize; }
+  size_t bufferCapacity() const { return _recSize ? kBufferBytes / stride() : 0; }
+  bool createNewFile(int index);
+  // Schneidet ein unvollständiges/CRC-falsches Ende ab; false = Rest steht noch
+  // in der Datei (seg.size zeigt trotzdem auf die letzte Satzgrenze)
+  bool recoverTail(LogSegment& seg, const String& path);
+  // false = nicht alles geschrieben (Rest bleibt im Puffer); full = zu wenig Platz
+  bool writeBuffer(bool& full);
+  bool rotateIfNeeded();
+  bool overBudget() const;
+  void removeOldest();
+  bool packSegment(size_t i);
+  String tempPath(const char* what) const;
+};
+
+// Liest Sätze blockweise ab einer LogCursor-Position über Dateigrenzen hinweg.
+// Hält höchstens eine Datei offen; vor dem Lesen LogStore::flush() aufrufen.
+class LogReader {
+public:
+  LogReader() {}
+  // lastSeg: letzte zu lesende Datei, endRec: Satzgrenze (exklusiv) in dieser Datei
+  LogReader(LogStore& store, const LogCursor& from, int lastSeg = 0x7FFFFFFF, uint32_t endRec = 0xFFFFFFFF)
+    : _store(&store), _cur(from), _lastSeg(lastSeg), _endRec(endRec) {}
+
+  // Liest bis zu max Sätze (je recordSize() Byte) nach out; 0 = Ende.
+  // Sätze mit falscher CRC werden übersprungen (zählen aber im Cursor).
+  size_t read(void* out, size_t max);
+
+  uint8_t recordSize() const { return _store ? _store->recordSize() : 0; }
+
+  // Position hinter dem zuletzt gelieferten Satz
+  const LogCursor& cursor() const { return _cur; }
+
+  void close() { if (_f) _f.close(); }
+
+private:
+  bool openCurrent();
+  size_t readPlain(uint8_t* out, size_t max, size_t& used);
+
+  LogStore* _store = nullptr;
+  LogCursor _cur;
+  int _lastSeg = 0x7FFFFFFF;
+  uint32_t _endRec = 0xFFFFFFFF;
+  File _f;
+  uint8_t _stride = 0;    // Byte je Satz in der offenen Datei
+  bool _packed = false;   // offene Datei ist gepackt: Sätze kommen aus _unpack
+  LogUnpacker _unpack;
+};
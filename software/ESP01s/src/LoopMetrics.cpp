@@ -0,0 +1,67 @@
+#include "LoopMetrics.h"
+
+static const char* const kStageNames[LoopMetrics::kStages] = {
+  "web", "mqtt", "logger", "energy", "mdns", "wifi", "sensor", "sample", "loop", "system"
+};
+
+const char* LoopMetrics::stageName(Stage s) {
+  return (s < kStages) ? kStageNames[s] : "?";
+}
+
+void LoopMetrics::Stat::add(uint32_t us) {
+  if (count == 0 || us < minUs) minUs = us;
+  if (us > maxUs) maxUs = us;
+  count++;
+  sumUs += us;
+  // Klasse = Anzahl signifikanter Bits (0 und 1 µs -> Klasse 0)
+  size_t b = us ? (size_t)(31 - __builtin_clz(us)) : 0;
+  if (b >= kBuckets) b = kBuckets - 1;
+  hist[b]++;
+}
+
+uint32_t LoopMetrics::Stat::percentile(uint8_t pct) const {
+  if (count == 0) return 0;
+  const uint64_t want = ((uint64_t)count * pct + 99) / 100;
+  uint64_t seen = 0;
+  for (size_t i = 0; i < kBuckets; ++i) {
+    seen += hist[i];
+    // obere Klassengrenze, gedeckelt auf das gemessene Maximum
+    if (seen >= want) return (i + 1 < kBuckets) ? min((uint32_t)(2UL << i) - 1, maxUs) : maxUs;
+  }
+  return maxUs;
+}
+
+uint32_t LoopMetrics::toUs(uint32_t cycles) {
+  return cycles / ESP.getCpuFreqMHz();
+}
+
+uint32_t LoopMetrics::lap(Stage s, uint32_t since) {
+  const uint32_t t = now();
+  _stages[s].add(toUs(t - since));
+  return t;
+}
+
+uint32_t LoopMetrics::beginLoop() {
+  const uint32_t t = now();
+  if (_loopEnd) _stages[System].add(toUs(t - _loopEnd));
+  return t;
+}
+
+void LoopMetrics::endLoop(uint32_t since) {
+  _loopEnd = lap(Loop, since);
+  if (_loopEnd == 0) _loopEnd = 1;
+  const uint32_t heap = ESP.getFreeHeap();
+  if (_heapMin == 0 || heap < _heapMin) _heapMin = heap;
+}
+
+void LoopMetrics::sampleLate(uint32_t lateMs) {
+  _late.add(lateMs * 1000UL);
+}
+
+void LoopMetrics::reset() {
+  for (Stat& s : _stages) s = Stat();
+  _late = Stat();
+  _loopEnd = 0;
+  _heapMin = 0;
+  _since = millis();
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <Arduino.h>
+
+// Laufzeitmessung der loop()-Stufen über den Zykluszähler: je Stufe Anzahl,
+// Summe, Min/Max und ein Histogramm mit Zweierpotenz-Klassen (1 µs .. 32 ms),
+// aus dem sich Perzentile abschätzen lassen. Dazu die Verspätung der
+// Logintervalle und der kleinste freie Heap. Kosten je Messpunkt: ein
+// Zählerstand, eine Division und ein paar Additionen.
+class LoopMetrics {
+public:
+  enum Stage : uint8_t {
+    Web,      // HTTP-Server inkl. Log-Streams
+    Mqtt,     // MQTT-Client
+    Logger,   // zeitgesteuerter Flush der Logs
+    Energy,   // Energie-Checkpoint
+    Mdns,     // MDNS.update()
+    Wifi,     // WLAN-Status und UDP-Keepalive
+    Sensor,   // Sensor-Ring: Ereignisregeln prüfen, Logintervall verdichten
+    Sample,   // Logintervall loggen, Energie
+    Loop,     // gesamte loop()
+    System,   // Zeit außerhalb von loop() (WLAN-Stack, SDK)
+    kStages
+  };
+  static const size_t kBuckets = 16; // Klasse i: < 2^(i+1) µs, letzte = Überlauf
+
+  struct Stat {
+    uint32_t count = 0;
+    uint64_t sumUs = 0;
+    uint32_t minUs = 0;
+    uint32_t maxUs = 0;
+    uint32_t hist[kBuckets] = {};
+
+    void add(uint32_t us);
+    // Obergrenze der Klasse, in die das Perzentil pct (0..100) fällt (µs)
+    uint32_t percentile(uint8_t pct) const;
+    uint32_t avgUs() const { return count ? (uint32_t)(sumUs / count) : 0; }
+  };
+
+  static const char* stageName(Stage s);
+
+  // Zählerstand für den Beginn einer Stufe
+  static uint32_t now() { return ESP.getCycleCount(); }
+
+  // Stufe seit 'since' verbuchen; liefert den neuen Zählerstand für die nächste
+  uint32_t lap(Stage s, uint32_t since);
+
+  // Beginn/Ende eines loop()-Durchlaufs (Loop, System, Heap-Minimum)
+  uint32_t beginLoop();
+  void endLoop(uint32_t since);
+
+  // Verspätung der Verarbeitung eines Logintervalls gegenüber seinem Ende (ms)
+  void sampleLate(uint32_t lateMs);
+  // Fehlerzähler der Abtastung (aus SensorINA219)
+  void setSensorCounters(uint32_t errors, uint32_t overruns) { _sensorErrors = errors; _sensorOverruns = overruns; }
+
+  const Stat& stage(Stage s) const { return _stages[s]; }
+  const Stat& lateness() const { return _late; }       // in µs
+  uint32_t heapMin() const { return _heapMin; }
+  uint32_t sensorErrors() const { return _sensorErrors; }
+  uint32_t sensorOverruns() const { return _sensorOverruns; }
+  unsigned long since() const { return _since; }       // millis() des letzten Zurücksetzens
+
+  // Alle Statistiken auf 0 (Messfenster neu beginnen)
+  void reset();
+
+private:
+  Stat _stages[kStages];
+  Stat _late;
+  uint32_t _loopEnd = 0;     // Zählerstand am Ende des letzten Durchlaufs (0 = keiner)
+  uint32_t _heapMin = 0;
+  uint32_t _sensorErrors = 0;
+  uint32_t _sensorOverruns = 0;
+  unsigned long _since = 0;
+
+  static uint32_t toUs(uint32_t cycles);
+};
@@ -1,30 +1,55 @@
 #include "MqttClientMgr.h"
+#include "EnergyMeter.h"
+#include "EventDetector.h"
 #include <math.h>
 
 static const char* kMqttConfigPath = "/mqtt.json";
-static const unsigned long kConfigCheckMs = 5000;
 
 MqttClientMgr::MqttClientMgr() : _client(_wifi) {}
 
-void MqttClientMgr::begin(const Measurement* latest) {
+// Values as published on the state topic: V, mA, W (NAN if not available)
+static void stateValues(const Measurement& m, float& v, float& i, float& p) {
+  v = m.busV;
+  if (isfinite(v) && v > 60.0f) v = v / 1000.0f;
+  i = m.currmA;
+  p = (isfinite(v) && isfinite(i)) ? v * (i / 1000.0f) : NAN;
+}
+
+void MqttClientMgr::begin(const Measurement* latest, const EnergyMeter* energy, EventDetector* events) {
   _latest = latest;
-  _client.setBufferSize(512);
-  _client.setSocketTimeout(2);
-  _wifi.setTimeout(2000);
-  _lastConfigCheck = 0;
-  _lastReconnectAttempt = 0;
-  _lastPublish = 0;
+  _energy = energy;
+  _events = events;
+  // history batches are the largest payloads (~50 bytes per sample)
+  _client.setBufferSize(1280);
+  // The broker has already accepted a TCP connection when connect() runs (see
+  // connectIfNeeded), so these only bound the CONNECT/CONNACK round trip.
+  _client.setSocketTimeout(1);
+  _wifi.setTimeout(1000);
+  _config.begin(kMqttConfigPath);
+  _configRev = 0;
+  _phase = Down;
+  _stateDirty = false;
   _failCount = 0;
   _nextRetryAt = 0;
+  _historySince = 0;
+  _queueReady = _queue.begin(MQTT_QUEUE_DIR, MQTT_QUEUE_FILE_SIZE, MQTT_QUEUE_FILES);
+  if (!_queueReady) logLine(String(F("[MQTT] history queue: no flash spill, RAM only")));
+  if (!_queue.empty()) _historySince = millis();
   logLine(String(F("[MQTT] init")));
 }
 
 void MqttClientMgr::loop() {
   _client.loop();
 
-  loadConfigIfNeeded();
+  applyConfigIfChanged();
   if (!_configured) return;
-  if (WiFi.status() != WL_CONNECTED) return;
+  if (WiFi.status() != WL_CONNECTED) {
+    if (_phase == Probing) {
+      _probe.cancel();
+      _phase = Down;
+    }
+    return;
+  }
 
   if (!connectIfNeeded()) return;
 
@@ -33,12 +58,38 @@ void MqttClientMgr::loop() {
     _discoveryPublished = true;
   }
 
-  if (millis() - _lastPublish >= SAMPLE_INTERVAL_MS) {
-    _lastPublish = millis();
-    publishState();
+  if (_stateDirty) {
+    _stateDirty = false;
+    if (!_onChange || !_stateSent || stateChanged()) publishState();
+  }
+  if (_onChange && _stateSent && millis() - _lastStateAt >= _heartbeatMs) publishState();
+
+  // events are rare and time-critical: one per loop(), ahead of the history
+  if (_events) publishEvent();
+
+  // at most one history batch per loop() so a long backlog doesn't stall sampling
+  if (_historySince && (_queue.hasBacklog() || _queue.ramCount() >= MQTT_HISTORY_BATCH ||
+                        millis() - _historySince >= MQTT_HISTORY_MAX_AGE_MS)) {
+    publishHistory();
   }
 }
 
+void MqttClientMgr::enqueue(const Measurement& m) {
+  _stateDirty = true;
+  // nobody to deliver to: don't let the history pile up on flash and replay
+  // stale data once a server is configured
+  if (!_configured || !_config.get().enabled()) return;
+  if (m.epoch == 0) return; // no time yet -> worthless for the history
+
+  QueuedSample q;
+  q.t  = (uint32_t)m.epoch;
+  q.mV = (uint16_t)constrain(lroundf(m.busV * 1000.0f), 0L, 65535L);
+  q.mA = (int16_t)constrain(lroundf(m.currmA), -32768L, 32767L);
+  q.mW = (int32_t)lroundf(m.powermW);
+  _queue.push(q);
+  if (!_historySince) _historySince = millis();
+}
+
 const String& MqttClientMgr::lastLog() const {
   return _lastLog;
 }
@@ -48,72 +99,102 @@ void MqttClientMgr::logLine(const String& line) {
   Serial.println(line);
 }
 
-void MqttClientMgr::loadConfigIfNeeded() {
-  if (millis() - _lastConfigCheck < kConfigCheckMs) return;
-  _lastConfigCheck = millis();
-
-  if (!LittleFS.exists(kMqttConfigPath)) {
-    if (_configured) logLine(String(F("[MQTT] config missing, disabling")));
-    _configured = false;
-    return;
-  }
+// Only acts when the store's revision moved (boot or a save via the web UI);
+// no file access here
+void MqttClientMgr::applyConfigIfChanged() {
+  if (_config.revision() == _configRev) return;
+  _configRev = _config.revision();
+  const MqttConfig& c = _config.get();
 
-  File f = LittleFS.open(kMqttConfigPath, "r");
-  if (!f) {
-    logLine(String(F("[MQTT] config open failed")));
-    _configured = false;
-    return;
-  }
-
-  StaticJsonDocument<256> doc;
-  DeserializationError err = deserializeJson(doc, f);
-  f.close();
-  if (err) {
-    logLine(String(F("[MQTT] config parse failed")));
-    _configured = false;
-    return;
-  }
-
-  String server = doc["server"] | "";
-  int port = doc["port"] | 0;
-  String user = doc["user"] | "";
-  String pass = doc["pass"] | "";
-  if (server.length() == 0 || port <= 0 || port > 65535) {
-    logLine(String(F("[MQTT] config invalid (server/port)")));
+  if (!c.enabled()) {
+    if (_configured) {
+      logLine(String(F("[MQTT] no server configured, disabling")));
+      _probe.cancel();
+      _phase = Down;
+      if (_client.connected()) _client.disconnect();
+    }
+    // also at boot: leftovers from before would be stale by the time it's enabled again
+    if (!_queue.empty()) _queue.clear();
+    _historySince = 0;
     _configured = false;
     return;
   }
 
-  if (!_configured || server != _server || (uint16_t)port != _port || user != _user || pass != _pass) {
-    _server = server;
-    _port = (uint16_t)port;
-    _user = user;
-    _pass = pass;
+  if (!_configured || c.server != _server || c.port != _port || c.user != _user || c.pass != _pass) {
+    _server = c.server;
+    _port = c.port;
+    _user = c.user;
+    _pass = c.pass;
     configureClient();
     _configured = true;
     logLine(String("[MQTT] config loaded: ") + _server + ":" + String(_port) +
             " user=" + (_user.length() ? _user : "(none)"));
   }
+
+  // state policy applies without reconnecting
+  _deadbandV = c.dbV;
+  _deadbandI = c.dbI;
+  _deadbandP = c.dbP;
+  _deadbandRel = c.dbRel;
+  _heartbeatMs = c.heartbeatS * 1000UL;
+  if (c.onChange != _onChange) {
+    _onChange = c.onChange;
+    logLine(_onChange ? String("[MQTT] state on change, heartbeat ") + String(c.heartbeatS) + "s"
+                      : String(F("[MQTT] state every sample")));
+  }
 }
 
 void MqttClientMgr::configureClient() {
-  _client.setServer(_server.c_str(), _port);
   _clientId = String("pd-logger-") + chipIdHex();
   _baseTopic = String("pd_logger/") + chipIdHex();
   _availabilityTopic = _baseTopic + "/availability";
+  _stateTopic = _baseTopic + "/state";
+  _historyTopic = _baseTopic + "/history";
+  _eventTopic = _baseTopic + "/event";
   _discoveryPublished = false;
+  _stateSent = false;
   _failCount = 0;
-  _nextRetryAt = 0;
+  _nextRetryAt = millis();
+  _probe.cancel();
+  _phase = Down;
   if (_client.connected()) _client.disconnect();
 }
 
+// Never blocks on an unreachable broker: DNS and the TCP handshake run in the
+// background (NetProbe) and are polled here. Only once the broker has accepted
+// a connection does PubSubClient::connect() run; it then just exchanges
+// CONNECT/CONNACK with a host that is known to answer.
 bool MqttClientMgr::connectIfNeeded() {
   if (_client.connected()) return true;
-  if (_nextRetryAt && millis() < _nextRetryAt) return false;
-  if (millis() - _lastReconnectAttempt < 5000) return false;
-  _lastReconnectAttempt = millis();
 
-  logLine(String("[MQTT] connecting to ") + _server + ":" + String(_port) + "...");
+  if (_phase == Up) {
+    logLine(String("[MQTT] connection lost, rc=") + String(_client.state()));
+    _phase = Down;
+    scheduleRetry();
+    return false;
+  }
+
+  if (_phase == Down) {
+    if ((long)(millis() - _nextRetryAt) < 0) return false;
+    logLine(String("[MQTT] connecting to ") + _server + ":" + String(_port) + "...");
+    _phase = Probing;
+    _probe.start(_server.c_str(), _port, MQTT_PROBE_TIMEOUT_MS);
+  }
+
+  switch (_probe.poll()) {
+    case NetProbe::Done:
+      break;
+    case NetProbe::Failed:
+      logLine(String("[MQTT] ") + _server + ": " + _probe.error());
+      _phase = Down;
+      scheduleRetry();
+      return false;
+    default:
+      return false;  // still resolving/connecting
+  }
+
+  _probe.cancel();
+  _client.setServer(_probe.ip(), _port);
   bool ok = _client.connect(
       _clientId.c_str(),
       _user.length() ? _user.c_str() : nullptr,
@@ -124,21 +205,31 @@ bool MqttClientMgr::connectIfNeeded() {
       "offline");
   if (!ok) {
     logLine(String("[MQTT] connect failed, rc=") + String(_client.state()));
-    if (_failCount < 255) _failCount++;
-    if (_failCount >= 3) {
-      _nextRetryAt = millis() + 60000UL;
-      logLine(String(F("[MQTT] backoff 60s after repeated failures")));
-    }
+    _phase = Down;
+    scheduleRetry();
     return false;
   }
 
+  _phase = Up;
   _failCount = 0;
-  _nextRetryAt = 0;
+  _stateSent = false;  // the broker may have lost the retained state
   _client.publish(_availabilityTopic.c_str(), "online", true);
   logLine(String(F("[MQTT] connected, availability=online")));
   return true;
 }
 
+// Exponential backoff with jitter: MQTT_RETRY_MIN_MS doubled per consecutive
+// failure up to MQTT_RETRY_MAX_MS, of which a random 50..100 % is waited
+void MqttClientMgr::scheduleRetry() {
+  if (_failCount < 255) _failCount++;
+  const uint8_t shift = _failCount - 1 < 16 ? _failCount - 1 : 16;
+  uint32_t window = MQTT_RETRY_MIN_MS << shift;
+  if (window > MQTT_RETRY_MAX_MS) window = MQTT_RETRY_MAX_MS;
+  const uint32_t wait = window / 2 + (uint32_t)random((long)(window / 2) + 1);
+  _nextRetryAt = millis() + wait;
+  logLine(String("[MQTT] retry in ") + String(wait / 1000UL) + "s (attempt " + String(_failCount) + ")");
+}
+
 void MqttClientMgr::publishDiscovery() {
   if (!_client.connected()) return;
 
@@ -149,17 +240,19 @@ void MqttClientMgr::publishDiscovery() {
                            const char* name,
                            const char* deviceClass,
                            const char* unit,
-                           const char* valueTemplate) {
+                           const char* valueTemplate,
+                           const char* stateClass) {
     StaticJsonDocument<512> doc;
     doc["name"] = name;
     doc["uniq_id"] = deviceId + "_" + suffix;
-    doc["stat_t"] = _baseTopic + "/state";
+    doc["stat_t"] = _stateTopic;
     doc["avty_t"] = _availabilityTopic;
     doc["pl_avail"] = "online";
     doc["pl_not_avail"] = "offline";
-    doc["dev_cla"] = deviceClass;
+    if (deviceClass) doc["dev_cla"] = deviceClass;
     doc["unit_of_meas"] = unit;
     doc["val_tpl"] = valueTemplate;
+    if (stateClass) doc["stat_cla"] = stateClass;
 
     JsonObject dev = doc.createNestedObject("device");
     JsonArray ids = dev.createNestedArray("identifiers");
@@ -174,30 +267,132 @@ void MqttClientMgr::publishDiscovery() {
     _client.publish(topic.c_str(), payload.c_str(), true);
   };
 
-  publishSensor("voltage", "PD-Logger Voltage", "voltage", "V", "{{ value_json.voltage }}");
-  publishSensor("current", "PD-Logger Current", "current", "mA", "{{ value_json.current }}");
-  publishSensor("power",   "PD-Logger Power",   "power",   "W", "{{ value_json.power }}");
+  publishSensor("voltage", "PD-Logger Voltage", "voltage", "V", "{{ value_json.voltage }}", "measurement");
+  publishSensor("current", "PD-Logger Current", "current", "mA", "{{ value_json.current }}", "measurement");
+  publishSensor("power",   "PD-Logger Power",   "power",   "W", "{{ value_json.power }}", "measurement");
+  if (_energy) {
+    // total_increasing: HA treats a drop (new day, session reset) as a new cycle
+    publishSensor("energy",         "PD-Logger Energy",         "energy", "Wh",  "{{ value_json.energy }}",         "total_increasing");
+    publishSensor("energy_today",   "PD-Logger Energy Today",   "energy", "Wh",  "{{ value_json.energy_today }}",   "total_increasing");
+    publishSensor("energy_session", "PD-Logger Energy Session", "energy", "Wh",  "{{ value_json.energy_session }}", "total_increasing");
+    publishSensor("charge_today",   "PD-Logger Charge Today",   nullptr,  "mAh", "{{ value_json.charge_today }}",   "total_increasing");
+    publishSensor("charge_session", "PD-Logger Charge Session", nullptr,  "mAh", "{{ value_json.charge_session }}", "total_increasing");
+  }
   logLine(String(F("[MQTT] discovery published")));
 }
 
+// True if V, I or P moved beyond its deadband since the last published state.
+// The band is the larger of the absolute and the relative deadband; with both
+// at 0 any change counts.
+bool MqttClientMgr::stateChanged() const {
+  if (!_latest) return false;
+  float v, i, p;
+  stateValues(*_latest, v, i, p);
+
+  auto moved = [this](float now, float last, float absBand) {
+    if (isfinite(now) != isfinite(last)) return true;
+    if (!isfinite(now)) return false;
+    const float band = max(absBand, fabsf(last) * _deadbandRel / 100.0f);
+    const float d = fabsf(now - last);
+    return band > 0 ? d >= band : d > 0;
+  };
+  return moved(v, _pubV, _deadbandV) || moved(i, _pubI, _deadbandI) || moved(p, _pubP, _deadbandP);
+}
+
 void MqttClientMgr::publishState() {
   if (!_client.connected() || !_latest) return;
 
-  float v = _latest->busV;
-  if (isfinite(v) && v > 60.0f) v = v / 1000.0f;
-  float i = _latest->currmA;
-  float p = (isfinite(v) && isfinite(i)) ? v * (i / 1000.0f) : NAN;
+  float v, i, p;
+  stateValues(*_latest, v, i, p);
 
-  StaticJsonDocument<128> doc;
-  if (isfinite(v)) doc["voltage"] = v;
-  if (isfinite(i)) doc["current"] = i;
-  if (isfinite(p)) doc["power"] = p;
+  // formatted in place: no JSON document and no String per publish
+  char payload[256];
+  size_t len = 0;
+  auto add = [&](const char* key, double val, int decimals) {
+    if (!isfinite(val) || len >= sizeof(payload)) return;
+    len += snprintf(payload + len, sizeof(payload) - len, "%s\"%s\":%.*f",
+                    len ? "," : "{", key, decimals, val);
+  };
+  add("voltage", v, 3);
+  add("current", i, 2);
+  add("power", p, 3);
+  if (_energy) {
+    add("energy",         _energy->total().mWh / 1000.0, 4);
+    add("energy_today",   _energy->today().mWh / 1000.0, 4);
+    add("energy_session", _energy->session().mWh / 1000.0, 4);
+    add("charge_today",   _energy->today().mAh, 3);
+    add("charge_session", _energy->session().mAh, 3);
+  }
+  if (len == 0) len = strlcpy(payload, "{", sizeof(payload));
+  if (len + 2 > sizeof(payload)) return;
+  payload[len++] = '}';
+  payload[len] = 0;
+
+  if (!_client.publish(_stateTopic.c_str(), payload, true)) {
+    logLine(String(F("[MQTT] state publish failed")));
+    return;
+  }
+  // runs every sample: log only the first publish per connection, not each payload
+  if (!_stateSent) logLine(String(F("[MQTT] state published")));
+  _pubV = v;
+  _pubI = i;
+  _pubP = p;
+  _lastStateAt = millis();
+  _stateSent = true;
+}
+
+// Publishes the oldest unsent event as one JSON object (see
+// EventDetector::formatJSON); it stays queued if the publish fails
+bool MqttClientMgr::publishEvent() {
+  EventRecord e;
+  if (!_client.connected() || !_events->peekUnsent(e)) return false;
+  char payload[EventDetector::kMaxJSON];
+  if (EventDetector::formatJSON(e, payload, sizeof(payload)) == 0) {
+    _events->popUnsent(); // unformattable, don't block the queue
+    return false;
+  }
+  if (!_client.publish(_eventTopic.c_str(), payload, false)) {
+    logLine(String(F("[MQTT] event publish failed")));
+    return false;
+  }
+  _events->popUnsent();
+  logLine(String("[MQTT] event published: ") + payload);
+  return true;
+}
+
+// Publishes the oldest queued samples as [{"t":..,"v":..,"i":..,"p":..},...]
+// (V, mA, W like the state topic); they stay queued if the publish fails
+bool MqttClientMgr::publishHistory() {
+  if (!_client.connected()) return false;
+
+  QueuedSample batch[MQTT_HISTORY_BATCH];
+  const size_t n = _queue.peek(batch, MQTT_HISTORY_BATCH);
+  if (n == 0) {
+    _historySince = 0;
+    return true;
+  }
 
   String payload;
-  serializeJson(doc, payload);
-  const String topic = _baseTopic + "/state";
-  _client.publish(topic.c_str(), payload.c_str(), true);
-  logLine(String("[MQTT] state published: ") + payload);
+  payload.reserve(n * 56 + 2);
+  payload += '[';
+  char item[72];
+  for (size_t k = 0; k < n; ++k) {
+    const QueuedSample& q = batch[k];
+    snprintf(item, sizeof(item), "%s{\"t\":%lu,\"v\":%.3f,\"i\":%d,\"p\":%.3f}",
+             k ? "," : "", (unsigned long)q.t, q.mV / 1000.0f, (int)q.mA, q.mW / 1000.0f);
+    payload += item;
+  }
+  payload += ']';
+
+  if (!_client.publish(_historyTopic.c_str(), payload.c_str(), false)) {
+    logLine(String(F("[MQTT] history publish failed")));
+    return false;
+  }
+  _queue.pop(n);
+  if (_queue.empty()) _historySince = 0;
+  else if (!_queue.hasBacklog() && _queue.ramCount() < MQTT_HISTORY_BATCH) _historySince = millis();
+  logLine(String("[MQTT] history published: ") + String((unsigned)n) + " samples");
+  return true;
 }
 
 String MqttClientMgr::chipIdHex() const {
@@ -0,0 +1,85 @@
+#include "MqttConfig.h"
+
+void MqttConfig::toJson(JsonDocument& doc) const {
+  doc["server"] = server;
+  doc["port"] = port;
+  doc["user"] = user;
+  doc["pass"] = pass;
+  doc["onChange"] = onChange;
+  doc["dbV"] = dbV;
+  doc["dbI"] = dbI;
+  doc["dbP"] = dbP;
+  doc["dbRel"] = dbRel;
+  doc["heartbeat"] = heartbeatS;
+}
+
+bool MqttConfig::fromJson(const JsonDocument& doc, const char*& err) {
+  const long p = doc["port"] | 1883L;
+  if (p <= 0 || p > 65535) {
+    err = "bad port";
+    return false;
+  }
+  const float v = doc["dbV"] | 0.0f;
+  const float i = doc["dbI"] | 0.0f;
+  const float w = doc["dbP"] | 0.0f;
+  const float rel = doc["dbRel"] | 0.0f;
+  if (!(v >= 0) || !(i >= 0) || !(w >= 0) || !(rel >= 0 && rel <= 100)) {
+    err = "bad deadband";
+    return false;
+  }
+  const long hb = doc["heartbeat"] | (long)MQTT_HEARTBEAT_S_DEFAULT;
+  if (hb < 1 || hb > (long)MQTT_HEARTBEAT_S_MAX) {
+    err = "bad heartbeat";
+    return false;
+  }
+
+  server = doc["server"] | "";
+  server.trim();
+  port = (uint16_t)p;
+  user = doc["user"] | "";
+  pass = doc["pass"] | "";
+  onChange = doc["onChange"] | false;
+  dbV = v;
+  dbI = i;
+  dbP = w;
+  dbRel = rel;
+  heartbeatS = (uint32_t)hb;
+  return true;
+}
+
+void MqttConfigStore::begin(const char* path) {
+  _path = path;
+  _cfg = MqttConfig();
+  _revision++;
+
+  File f = LittleFS.open(_path, "r");
+  if (!f) return;
+  StaticJsonDocument<384> doc;
+  const DeserializationError err = deserializeJson(doc, f);
+  f.close();
+  const char* why = "";
+  if (err || !_cfg.fromJson(doc, why)) {
+    Serial.printf("MQTT-Konfiguration %s ungültig, MQTT aus\n", _path.c_str());
+    _cfg = MqttConfig();
+  }
+}
+
+bool MqttConfigStore::save(const MqttConfig& cfg) {
+  StaticJsonDocument<384> doc;
+  cfg.toJson(doc);
+
+  // erst vollständig in eine Hilfsdatei, dann umbenennen: ein Stromausfall
+  // beim Schreiben lässt die alte Konfiguration intakt
+  const String tmp = _path + ".tmp";
+  File f = LittleFS.open(tmp, "w");
+  if (!f) return false;
+  const size_t w = serializeJson(doc, f);
+  f.close();
+  if (w == 0 || !LittleFS.rename(tmp, _path)) {
+    LittleFS.remove(tmp);
+    return false;
+  }
+  _cfg = cfg;
+  _revision++;
+  return true;
+}
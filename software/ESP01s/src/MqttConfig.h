@@ -0,0 +1,49 @@
+#pragma once
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <ArduinoJson.h>
+#include "Config.h"
+
+// MQTT-Einstellungen (Inhalt von /mqtt.json)
+struct MqttConfig {
+  String server;
+  uint16_t port = 1883;
+  String user;
+  String pass;
+  // State-Regel: Totzonen in V, mA, W und % des zuletzt gesendeten Werts
+  bool onChange = false;
+  float dbV = 0;
+  float dbI = 0;
+  float dbP = 0;
+  float dbRel = 0;
+  uint32_t heartbeatS = MQTT_HEARTBEAT_S_DEFAULT;
+
+  // Broker angegeben (sonst bleibt MQTT aus)
+  bool enabled() const { return server.length() > 0; }
+
+  void toJson(JsonDocument& doc) const;
+  // Übernimmt die Felder aus doc (fehlende = Standardwert); bei ungültigen
+  // Werten false und err = Grund, *this bleibt dann unverändert
+  bool fromJson(const JsonDocument& doc, const char*& err);
+};
+
+// Gemeinsamer Stand der MQTT-Einstellungen im RAM: einmal beim Start gelesen,
+// danach nur noch über save() geändert (Hilfsdatei + rename). Jede Änderung
+// erhöht revision(); Nutzer vergleichen sie mit ihrem letzten Stand statt die
+// Datei erneut zu lesen.
+class MqttConfigStore {
+public:
+  // Lädt path (z.B. "/mqtt.json"); fehlt die Datei, gelten die Standardwerte
+  void begin(const char* path);
+
+  const MqttConfig& get() const { return _cfg; }
+  uint32_t revision() const { return _revision; }
+
+  // Speichert cfg dauerhaft und übernimmt sie; false = Schreiben fehlgeschlagen
+  bool save(const MqttConfig& cfg);
+
+private:
+  String _path;
+  MqttConfig _cfg;
+  uint32_t _revision = 0;
+};
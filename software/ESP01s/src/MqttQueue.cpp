@@ -0,0 +1,111 @@
+#include "MqttQueue.h"
+#include <LittleFS.h>
+
+bool MqttQueue::begin(const char* dir, size_t maxFileSize, size_t maxFiles) {
+  _ramHead = _ramCount = 0;
+  _cursor = _peekEnd = LogCursor();
+  _peekFromSpill = 0;
+  _cursorPath = String(dir) + "/cursor";
+  // gebündelt schreiben: ein Spill-Block = ein bis zwei Flushes
+  _spill.setFlushPolicy(LogStore::kBufferBytes / sizeof(QueuedSample), 60000UL);
+  if (!_spill.begin(dir, "q_", ".bin", sizeof(QueuedSample), maxFileSize, maxFiles)) return false;
+
+  // Reste aus der Zeit vor dem Neustart werden ebenfalls nachgeliefert, ab
+  // dem zuletzt bestätigten Block (fehlt die Position: alles)
+  loadCursor();
+  const LogCursor end = _spill.endCursor();
+  _spilled = false;
+  for (size_t i = 0; i < _spill.segmentCount(); ++i) {
+    if (_spill.segmentRecords(i)) _spilled = true;
+  }
+  if (_cursor.seg == end.seg && _cursor.rec == end.rec) _spilled = false;
+  return true;
+}
+
+// Leseposition im Flash: 8 Byte (seg, rec). Eine halb geschriebene oder nicht
+// mehr passende Datei zählt als fehlend, dann kommen höchstens Dubletten.
+void MqttQueue::loadCursor() {
+  File f = LittleFS.open(_cursorPath, "r");
+  if (!f) return;
+  LogCursor c;
+  int32_t seg = -1;
+  const bool ok = f.read((uint8_t*)&seg, sizeof(seg)) == sizeof(seg) &&
+                  f.read((uint8_t*)&c.rec, sizeof(c.rec)) == sizeof(c.rec);
+  f.close();
+  c.seg = seg;
+  if (ok && _spill.contains(c)) _cursor = c;
+}
+
+void MqttQueue::saveCursor() {
+  File f = LittleFS.open(_cursorPath, "w");
+  if (!f) return;
+  const int32_t seg = _cursor.seg;
+  f.write((const uint8_t*)&seg, sizeof(seg));
+  f.write((const uint8_t*)&_cursor.rec, sizeof(_cursor.rec));
+  f.close();
+}
+
+void MqttQueue::clear() {
+  _ramHead = _ramCount = 0;
+  _cursor = _peekEnd = LogCursor();
+  _peekFromSpill = 0;
+  if (_spill.ready()) _spill.clearAll();
+  LittleFS.remove(_cursorPath);
+  _spilled = false;
+}
+
+void MqttQueue::push(const QueuedSample& s) {
+  if (_ramCount == kRamSize) spillOldest(kSpillBlock);
+  _ram[(_ramHead + _ramCount) % kRamSize] = s;
+  _ramCount++;
+}
+
+void MqttQueue::spillOldest(size_t n) {
+  n = min(n, _ramCount);
+  if (_spill.ready()) {
+    for (size_t k = 0; k < n; ++k) _spill.append(&_ram[(_ramHead + k) % kRamSize]);
+    _spill.flush();
+    _spilled = true;
+    _spillTotal += n;
+  }
+  // ohne Flash gehen die ältesten Sätze verloren
+  _ramHead = (_ramHead + n) % kRamSize;
+  _ramCount -= n;
+  _peekFromSpill = 0;
+}
+
+size_t MqttQueue::peek(QueuedSample* out, size_t max) {
+  _peekFromSpill = 0;
+  if (_spilled) {
+    _spill.flush();
+    LogReader rd(_spill, _cursor);
+    const size_t n = rd.read(out, max);
+    rd.close();
+    if (n) {
+      _peekEnd = rd.cursor();
+      _peekFromSpill = n;
+      return n;
+    }
+    // Flash vollständig gesendet: Dateien leeren, weiter mit dem RAM
+    _spill.clearAll();
+    LittleFS.remove(_cursorPath);
+    _cursor = LogCursor();
+    _spilled = false;
+  }
+
+  const size_t n = min(max, _ramCount);
+  for (size_t k = 0; k < n; ++k) out[k] = _ram[(_ramHead + k) % kRamSize];
+  return n;
+}
+
+void MqttQueue::pop(size_t n) {
+  if (_peekFromSpill) {
+    _cursor = _peekEnd;
+    _peekFromSpill = 0;
+    saveCursor(); // sonst liefert ein Neustart alles seit dem letzten Leeren erneut
+    return;
+  }
+  n = min(n, _ramCount);
+  _ramHead = (_ramHead + n) % kRamSize;
+  _ramCount -= n;
+}
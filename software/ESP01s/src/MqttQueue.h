@@ -0,0 +1,57 @@
+#pragma once
+#include <Arduino.h>
+#include "LogStore.h"
+
+// Noch nicht per MQTT veröffentlichter Messwert (12 Byte)
+struct __attribute__((packed)) QueuedSample {
+  uint32_t t;    // epoch (Ende des Logintervalls)
+  uint16_t mV;   // Busspannung
+  int16_t  mA;   // Strom
+  int32_t  mW;   // Leistung
+};
+
+// Begrenzte Warteschlange für die MQTT-Historie: neue Werte landen in einem
+// RAM-Ring; ist er voll, wandert der älteste Block in einen rotierenden
+// LogStore auf LittleFS (bei vollem Flash-Budget fallen die ältesten Dateien
+// weg). Gelesen wird immer vom ältesten Wert an – erst Flash, dann RAM.
+// peek() liefert einen Block, pop() gibt ihn nach erfolgreichem Senden frei;
+// die Leseposition im Flash übersteht einen Neustart.
+class MqttQueue {
+public:
+  static const size_t kRamSize = 64;     // Sätze im RAM (~5 min bei 5 s)
+  static const size_t kSpillBlock = 32;  // so viele gehen bei vollem RAM auf einmal in den Flash
+
+  // Flash-Teil: z.B. dir="/mqttq", 4 Dateien à 4 KB (~1,9 h bei 5 s)
+  bool begin(const char* dir, size_t maxFileSize, size_t maxFiles);
+
+  void push(const QueuedSample& s);
+
+  // Kopiert bis zu max der ältesten Sätze nach out, ohne sie zu entfernen
+  size_t peek(QueuedSample* out, size_t max);
+  // Entfernt die n zuletzt mit peek() gelieferten Sätze
+  void pop(size_t n);
+  // Verwirft alles (RAM und Flash), z.B. wenn MQTT abgeschaltet wird
+  void clear();
+
+  bool empty() const { return _ramCount == 0 && !_spilled; }
+  bool hasBacklog() const { return _spilled; }    // Sätze im Flash
+  size_t ramCount() const { return _ramCount; }
+  uint32_t spillCount() const { return _spillTotal; } // in den Flash ausgelagerte Sätze seit Start
+
+private:
+  QueuedSample _ram[kRamSize];
+  size_t _ramHead = 0;    // ältester Satz
+  size_t _ramCount = 0;
+
+  LogStore _spill;
+  LogCursor _cursor;      // nächster ungesendeter Satz im Flash (auch in _cursorPath)
+  String _cursorPath;
+  LogCursor _peekEnd;     // Position hinter dem letzten peek() aus dem Flash
+  size_t _peekFromSpill = 0;
+  bool _spilled = false;  // Flash enthält ungesendete Sätze
+  uint32_t _spillTotal = 0;
+
+  void spillOldest(size_t n);
+  void loadCursor();
+  void saveCursor();
+};
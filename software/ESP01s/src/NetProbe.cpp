@@ -0,0 +1,126 @@
+#include "NetProbe.h"
+
+bool NetProbe::start(const char* host, uint16_t port, uint32_t timeoutMs) {
+  cancel();
+  strlcpy(_host, host, sizeof(_host));
+  _port = port;
+  _startMs = millis();
+  _timeoutMs = timeoutMs;
+  _error = "";
+
+  // IP-Adresse direkt angegeben: keine Namensauflösung
+  if (_ip.fromString(_host)) {
+    connectTcp();
+    return _state != Failed;
+  }
+
+#ifdef ESP8266
+  ip_addr_t addr;
+  _state = Resolving;
+  const err_t err = dns_gethostbyname(_host, &addr, &NetProbe::onDns, this);
+  if (err == ERR_OK) {
+    // aus dem DNS-Cache
+    _ip = IPAddress(addr);
+    connectTcp();
+  } else if (err != ERR_INPROGRESS) {
+    fail("dns request failed");
+  }
+#else
+  // Host: Auflösung sofort
+  if (WiFi.hostByName(_host, _ip)) connectTcp();
+  else fail("dns failed");
+#endif
+  return _state != Failed;
+}
+
+NetProbe::State NetProbe::poll() {
+  if ((_state == Resolving || _state == Connecting) && millis() - _startMs >= _timeoutMs) {
+    fail(_state == Resolving ? "dns timeout" : "connect timeout");
+  }
+  return _state;
+}
+
+void NetProbe::cancel() {
+#ifdef ESP8266
+  releasePcb();
+#endif
+  _state = Idle;
+}
+
+void NetProbe::fail(const char* why) {
+#ifdef ESP8266
+  releasePcb();
+#endif
+  _error = why;
+  _state = Failed;
+}
+
+#ifdef ESP8266
+
+void NetProbe::connectTcp() {
+  _pcb = tcp_new();
+  if (!_pcb) {
+    fail("out of memory");
+    return;
+  }
+  tcp_arg(_pcb, this);
+  tcp_err(_pcb, &NetProbe::onError);
+  _state = Connecting;
+  ip_addr_t addr = _ip;
+  if (tcp_connect(_pcb, &addr, _port, &NetProbe::onConnected) != ERR_OK) {
+    fail("connect failed");
+  }
+}
+
+void NetProbe::releasePcb() {
+  if (!_pcb) return;
+  tcp_arg(_pcb, nullptr);
+  tcp_err(_pcb, nullptr);
+  // Verbindung wird nicht gebraucht: sofort verwerfen (RST), belegt keinen Speicher
+  tcp_abort(_pcb);
+  _pcb = nullptr;
+}
+
+// Die Callbacks laufen im Kontext des Netzwerkstacks zwischen zwei loop()-Durchläufen
+
+void NetProbe::onDns(const char* name, const ip_addr_t* addr, void* arg) {
+  NetProbe* self = static_cast<NetProbe*>(arg);
+  // verspätete Antwort einer abgebrochenen Prüfung ignorieren
+  if (self->_state != Resolving || strcmp(name, self->_host) != 0) return;
+  if (!addr) {
+    self->fail("host not found");
+    return;
+  }
+  self->_ip = IPAddress(addr);
+  self->connectTcp();
+}
+
+err_t NetProbe::onConnected(void* arg, tcp_pcb* pcb, err_t err) {
+  NetProbe* self = static_cast<NetProbe*>(arg);
+  if (!self || self->_pcb != pcb) return ERR_OK;
+  tcp_arg(pcb, nullptr);
+  tcp_err(pcb, nullptr);
+  self->_pcb = nullptr;
+  tcp_abort(pcb);
+  self->_state = (err == ERR_OK) ? Done : Failed;
+  if (err != ERR_OK) self->_error = "connect failed";
+  return ERR_ABRT;  // pcb ist freigegeben
+}
+
+void NetProbe::onError(void* arg, err_t err) {
+  NetProbe* self = static_cast<NetProbe*>(arg);
+  if (!self) return;
+  // lwIP hat den pcb bereits freigegeben
+  self->_pcb = nullptr;
+  self->_error = (err == ERR_RST) ? "connection refused" : "connect failed";
+  self->_state = Failed;
+}
+
+#else
+
+void NetProbe::connectTcp() {
+  // Host: Server gilt als erreichbar
+  _state = Done;
+}
+
+#endif
@@ -0,0 +1,50 @@
+#pragma once
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+#ifdef ESP8266
+#include <lwip/dns.h>
+#include <lwip/tcp.h>
+#endif
+
+// Erreichbarkeitsprüfung eines Servers ohne Blockieren von loop(): Namens-
+// auflösung über die asynchrone lwIP-DNS-Abfrage, danach ein TCP-Verbindungs-
+// aufbau über die rohe lwIP-API. Beides meldet sich per Callback; poll()
+// fragt nur den Zustand ab und bricht nach der Zeitgrenze ab. Nach Done steht
+// die Adresse in ip() und der Server hat den Verbindungsaufbau angenommen.
+class NetProbe {
+public:
+  enum State : uint8_t { Idle, Resolving, Connecting, Done, Failed };
+
+  ~NetProbe() { cancel(); }
+
+  // Startet die Prüfung; false = sofort fehlgeschlagen (siehe error())
+  bool start(const char* host, uint16_t port, uint32_t timeoutMs);
+  // Aktueller Zustand, prüft die Zeitgrenze
+  State poll();
+  // Laufende Prüfung abbrechen (Verbindung verwerfen), Zustand Idle
+  void cancel();
+
+  State state() const { return _state; }
+  IPAddress ip() const { return _ip; }
+  const char* error() const { return _error; }
+
+private:
+  volatile State _state = Idle;
+  const char* _error = "";
+  IPAddress _ip;
+  uint16_t _port = 0;
+  uint32_t _startMs = 0;
+  uint32_t _timeoutMs = 0;
+  char _host[64] = {};
+
+  void fail(const char* why);
+  void connectTcp();
+
+#ifdef ESP8266
+  tcp_pcb* _pcb = nullptr;
+  static void onDns(const char* name, const ip_addr_t* addr, void* arg);
+  static err_t onConnected(void* arg, tcp_pcb* pcb, err_t err);
+  static void onError(void* arg, err_t err);
+  void releasePcb();
+#endif
+};
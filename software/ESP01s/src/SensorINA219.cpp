@@ -2,46 +2,176 @@
 #include "Config.h"
 #include <math.h>
 
-bool SensorINA219::begin(TwoWire& w) {
+// INA219-Register
+static const uint8_t REG_CONFIG = 0x00;
+static const uint8_t REG_SHUNT  = 0x01;
+static const uint8_t REG_BUS    = 0x02;
+
+// Config: 32 V Bereich, PGA /8 (±320 mV), Shunt+Bus kontinuierlich
+static const uint16_t CFG_BRNG_32V     = 0x2000;
+static const uint16_t CFG_PGA_DIV8     = 0x1800;
+static const uint16_t CFG_MODE_CONT_SB = 0x0007;
+
+// ADC-Code für n gemittelte 12-Bit-Wandlungen: 1 -> 0b1000 ... 128 -> 0b1111
+static uint16_t adcCode(uint8_t samples) {
+  uint16_t code = 0x8;
+  while (samples > 1 && code < 0xF) { samples >>= 1; code++; }
+  return code;
+}
+
+bool SensorINA219::begin(TwoWire& w, uint16_t periodMs, uint8_t avgSamples, uint32_t intervalMs) {
+  _ticker.detach();
   _wire = &w;
+  if (periodMs == 0) periodMs = 1;
+  _periodMs = periodMs;
+  _ticksPerInterval = max(intervalMs / periodMs, (uint32_t)1);
   if (!_ina.begin(_wire)) {
     return false;
   }
-  _ina.setCalibration_32V_2A();
+  // Strom/Leistung rechnen wir selbst aus der Shuntspannung; das Config-Register
+  // bekommt die Mittelung für Bus- und Shunt-ADC
+  const uint16_t adc = adcCode(avgSamples);
+  const uint16_t cfg = CFG_BRNG_32V | CFG_PGA_DIV8 | (adc << 7) | (adc << 3) | CFG_MODE_CONT_SB;
+  if (!writeReg(REG_CONFIG, cfg)) return false;
+
+  _head = _tail = 0;
+  _markHead = _markTail = 0;
+  _tick = 0;
+  _lastMarkMs = millis();
+  _ticker.attach_ms(periodMs, &SensorINA219::onTick, this);
   return true;
 }
 
+bool SensorINA219::writeReg(uint8_t reg, uint16_t val) {
+  _wire->beginTransmission(_addr);
+  _wire->write(reg);
+  _wire->write((uint8_t)(val >> 8));
+  _wire->write((uint8_t)(val & 0xFF));
+  return _wire->endTransmission() == 0;
+}
 
-static bool finiteRange(float x, float lo, float hi) {
-  return isfinite(x) && x >= lo && x <= hi;
+bool SensorINA219::readReg(uint8_t reg, uint16_t& out) {
+  // Registerzeiger setzen, dann 2 Byte (MSB zuerst); der INA219 zählt den Zeiger nicht weiter
+  _wire->beginTransmission(_addr);
+  _wire->write(reg);
+  if (_wire->endTransmission() != 0) return false;
+  if (_wire->requestFrom(_addr, (uint8_t)2) != 2) return false;
+  const uint8_t hi = _wire->read();
+  const uint8_t lo = _wire->read();
+  out = ((uint16_t)hi << 8) | lo;
+  return true;
 }
 
-bool SensorINA219::read(Measurement& m) {
-  // bis zu 3 Versuche bei Ausfall
-  for (int attempt = 0; attempt < 3; ++attempt) {
-    float shuntmV = _ina.getShuntVoltage_mV();
-    float busV    = _ina.getBusVoltage_V();
-    float currmA  = _ina.getCurrent_mA();
-    float powermW = _ina.getPower_mW();
+bool SensorINA219::readSample(RawSample& s) {
+  uint16_t shunt, bus;
+  if (!readReg(REG_SHUNT, shunt) || !readReg(REG_BUS, bus)) return false;
+  if (bus & 0x0001) return false; // OVF: Messbereich überschritten
+  s.shunt = (int16_t)shunt;
+  s.bus   = bus;
+  return true;
+}
 
-    // Plausibilitätsgrenzen (nach Kalibrierung anpassen!)
-    bool ok =
-      finiteRange(busV,   0.0f, 26.0f) &&        // INA219 Bus max ~26 V
-      finiteRange(currmA, -5000.f, 5000.f) &&    // ±5 A Spielraum
-      finiteRange(shuntmV, -100.0f, 100.0f) &&   // ±100 mV über Shunt
-      finiteRange(powermW, -20000.f, 20000.f);   // ±20 W Reserve
+// Erzeuger (Ticker): eine Abtastung in den Ring, nach jedem vollen Intervall
+// eine Grenze. Bei vollem Ring wird verworfen statt überschrieben, damit
+// loop() nie gleichzeitig mit dem Ticker an derselben Stelle arbeitet.
+void SensorINA219::sample() {
+  RawSample s;
+  if (readSample(s)) {
+    const uint16_t next = (_head + 1) & (kRingSize - 1);
+    if (next == _tail) {
+      _overruns++;
+    } else {
+      _ring[_head] = s;
+      __sync_synchronize(); // Satz vor dem Index sichtbar machen
+      _head = next;
+    }
+  } else {
+    _errors++;
+  }
 
-    if (ok) {
-      m.shuntmV = shuntmV;
-      m.busV    = busV;
-      m.currmA  = currmA * _corr;   // Korrektur anwenden
-      m.powermW = powermW * _corr;  // Leistung skaliert linear mit Strom
-      m.loadV   = m.busV + (m.shuntmV / 1000.0f);
-      return true;
+  if (++_tick % _ticksPerInterval) return;
+  const uint8_t next = (_markHead + 1) & (kMarkRingSize - 1);
+  if (next == _markTail) {
+    _overruns++; // Intervall geht im nächsten auf (Energie über die echte Dauer)
+    return;
+  }
+  _marks[_markHead].ms  = millis();
+  _marks[_markHead].end = _head;
+  __sync_synchronize();
+  _markHead = next;
+}
+
+// Verbraucher (loop()): Abtastungen bis zur ältesten Intervallgrenze verdichten
+bool SensorINA219::takeInterval(Measurement& m) {
+  if (!intervalReady()) return false;
+  const Mark mk = _marks[_markTail];
+  const uint32_t dtMs = mk.ms - _lastMarkMs;
+  _lastMarkMs = mk.ms;
+  m.ms = mk.ms;
+
+  const size_t n = (mk.end - _tail) & (kRingSize - 1);
+  float sumBus = 0, sumShunt = 0, sumI = 0, sumP = 0;
+  float vMin = 0, vMax = 0, iMin = 0, iMax = 0, pMin = 0, pMax = 0;
+  size_t pos = _tail;
+  for (size_t k = 0; k < n; ++k) {
+    const RawSample& s = _ring[pos];
+    pos = (pos + 1) & (kRingSize - 1);
+
+    const float busV    = SensorINA219::busV(s);
+    const float shuntmV = s.shunt * 0.01f;
+    const float currmA  = currentmA(s);
+    const float powermW = busV * currmA;
+    if (k == 0) {
+      vMin = vMax = busV;
+      iMin = iMax = currmA;
+      pMin = pMax = powermW;
+    } else {
+      vMin = min(vMin, busV);     vMax = max(vMax, busV);
+      iMin = min(iMin, currmA);   iMax = max(iMax, currmA);
+      pMin = min(pMin, powermW);  pMax = max(pMax, powermW);
     }
+    sumBus += busV;
+    sumShunt += shuntmV;
+    sumI += currmA;
+    sumP += powermW;
+  }
+  // Plätze und Grenze erst nach dem Lesen freigeben
+  __sync_synchronize();
+  _tail = mk.end;
+  _markTail = (_markTail + 1) & (kMarkRingSize - 1);
+  if (n == 0) return false; // Caller soll diese Messung nicht loggen
 
-    // kurzer Yield + nächster Versuch
-    yield();
+  m.busV       = sumBus / n;
+  m.shuntmV    = sumShunt / n;
+  m.currmA     = sumI / n;
+  m.powermW    = sumP / n;   // Mittel der Momentanleistungen, nicht Ū·Ī
+  m.loadV      = m.busV + (m.shuntmV / 1000.0f);
+  m.samples    = (uint16_t)min(n, (size_t)65535);
+  m.busMinV    = vMin;
+  m.busMaxV    = vMax;
+  m.currMinmA  = iMin;
+  m.currMaxmA  = iMax;
+  m.powerMinmW = pMin;
+  m.powerMaxmW = pMax;
+  m.energymWh  = m.powermW * (dtMs / 3600000.0f);
+  m.chargemAh  = m.currmA * (dtMs / 3600000.0f);
+  return true;
+}
+
+// Beobachter (loop()): [tail, head) schreibt der Ticker nicht, und tail rückt
+// nur in takeInterval() weiter – also ebenfalls in loop()
+size_t SensorINA219::readRaw(uint16_t& pos, RawSample* out, size_t max) const {
+  const uint16_t head = _head;
+  __sync_synchronize(); // Index vor den Sätzen lesen
+  const uint16_t tail = _tail;
+  const size_t avail = (head - tail) & (kRingSize - 1);
+  size_t off = (pos - tail) & (kRingSize - 1);
+  if (off > avail) {
+    pos = tail; // schon verdichtet und freigegeben
+    off = 0;
   }
-  return false; // Caller soll diese Messung nicht loggen
-}
\ No newline at end of file
+  const size_t n = min(max, avail - off);
+  for (size_t k = 0; k < n; ++k) out[k] = _ring[(pos + k) & (kRingSize - 1)];
+  pos = (pos + n) & (kRingSize - 1);
+  return n;
+}
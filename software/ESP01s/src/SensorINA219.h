@@ -2,16 +2,80 @@
 #include <Arduino.h>
 #include <Wire.h>
 #include <Adafruit_INA219.h>
+#include <Ticker.h>
 #include "Measurement.h"
 
+// INA219 im Schnellmodus: ADC-Mittelung im Chip, nur Shunt- und Busregister
+// lesen. Die Abtastung läuft per Ticker (SDK-Timer) und damit auch weiter,
+// während loop() in Netzwerkaufrufen wartet. Rohwerte und Intervallgrenzen
+// gehen über lock-freie Ringe (ein Erzeuger, ein Verbraucher) an loop(), das
+// je Logintervall auf Mittel/Min/Max/Energie verdichtet.
 class SensorINA219 {
 public:
-  bool begin(TwoWire& w);
-  bool read(Measurement& m);
-  void setShuntCorrection(float factor) { _corr = (isfinite(factor) && factor > 0) ? factor : 1.0f; }
+  // Rohwerte einer Abtastung (Registerinhalte, 4 Byte)
+  struct RawSample {
+    int16_t  shunt;  // Shuntspannung, LSB 10 µV
+    uint16_t bus;    // Busspannung, Bits 15..3, LSB 4 mV
+  };
+  static const size_t kRingSize = 256;   // 12,8 s bei 20 Hz (Zweierpotenz)
+  static const size_t kMarkRingSize = 8; // abgeschlossene, noch nicht abgeholte Intervalle
+
+  // periodMs: Abtastabstand, avgSamples: ADC-Mittelung im Chip (1..128, Zweierpotenz),
+  // intervalMs: Logintervall (Vielfaches von periodMs); startet den Ticker
+  bool begin(TwoWire& w, uint16_t periodMs = 50, uint8_t avgSamples = 16, uint32_t intervalMs = 5000);
+  void setShuntMilliohm(float mOhm) { _shuntOhm = (isfinite(mOhm) && mOhm > 0) ? mOhm / 1000.0f : 0.1f; }
+
+  // true = mindestens ein abgeschlossenes Logintervall wartet
+  bool intervalReady() const { return _markTail != _markHead; }
+
+  // Verdichtet das älteste abgeschlossene Intervall nach m (Mittelwerte +
+  // Min/Max/Energie, m.ms = millis() am Intervallende); false = keine gültige
+  // Abtastung im Intervall (es ist trotzdem abgeholt)
+  bool takeInterval(Measurement& m);
+
+  // Rohwerte für Beobachter in loop() (Live-Anzeige): kopiert bis zu max
+  // Abtastungen ab Ringposition pos nach out und rückt pos weiter. Lesbar ist
+  // nur der noch nicht verdichtete Teil des Rings; liegt pos davor, geht es
+  // beim ältesten vorhandenen Satz weiter.
+  size_t readRaw(uint16_t& pos, RawSample* out, size_t max) const;
+  uint16_t rawHead() const { return _head; }     // Startposition für "ab jetzt"
+  uint16_t periodMs() const { return _periodMs; }
+  static float busV(const RawSample& s) { return (s.bus >> 3) * 0.004f; }
+  float currentmA(const RawSample& s) const { return s.shunt * 0.01f / _shuntOhm; }
+
+  uint32_t errors() const { return _errors; }    // fehlgeschlagene I2C-Lesezugriffe
+  uint32_t overruns() const { return _overruns; } // verworfene Abtastungen/Intervalle (Ring voll)
 
 private:
+  // Intervallgrenze: Ringposition hinter der letzten Abtastung + Zeitpunkt
+  struct Mark {
+    uint32_t ms;
+    uint16_t end;
+  };
+
   Adafruit_INA219 _ina;
+  Ticker _ticker;
   TwoWire* _wire = nullptr;
-  float _corr = 1.0f;
-};
\ No newline at end of file
+  uint8_t _addr = 0x40;
+  float _shuntOhm = 0.1f;
+  uint16_t _periodMs = 50;
+  uint32_t _ticksPerInterval = 100;
+  uint32_t _tick = 0;           // nur Erzeuger
+  uint32_t _lastMarkMs = 0;     // nur Verbraucher
+
+  // Ringe: head schreibt nur der Ticker, tail nur loop()
+  RawSample _ring[kRingSize];
+  volatile uint16_t _head = 0;
+  volatile uint16_t _tail = 0;
+  Mark _marks[kMarkRingSize];
+  volatile uint8_t _markHead = 0;
+  volatile uint8_t _markTail = 0;
+  volatile uint32_t _errors = 0;
+  volatile uint32_t _overruns = 0;
+
+  static void onTick(SensorINA219* self) { self->sample(); }
+  void sample();
+  bool readReg(uint8_t reg, uint16_t& out);
+  bool writeReg(uint8_t reg, uint16_t val);
+  bool readSample(RawSample& s);
+};
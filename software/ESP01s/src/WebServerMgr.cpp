@@ -3,14 +3,112 @@
 #include <ESP8266WiFi.h>
 #include "MqttClientMgr.h"
 
-static const char* kMqttConfigPath = "/mqtt.json";
+static const char* kAssetManifestPath = "/www/assets.json";
 
 static String getParam(ESP8266WebServer& srv, const String& name) {
   if (!srv.hasArg(name)) return String();
   return srv.arg(name);
 }
 
+// Zeitfenster aus ?sec=<Sekunden>|max: liefert den Beginn (0 = alles) und die
+// aktuelle Zeit (0 = NTP noch nicht synchron)
+static uint32_t windowStart(ESP8266WebServer& srv, uint32_t& nowEpoch) {
+  time_t now = time(nullptr);
+  nowEpoch = (now < 100000) ? 0 : (uint32_t)now; // falls NTP noch nicht synchron
+
+  long windowSec = 0; // 0 => alles
+  if (srv.hasArg("sec") && !srv.arg("sec").equalsIgnoreCase("max")) {
+    windowSec = srv.arg("sec").toInt(); // ungültig -> 0
+    if (windowSec < 0) windowSec = 0;
+  }
+  return (nowEpoch > 0 && windowSec > 0) ? (nowEpoch - (uint32_t)windowSec) : 0;
+}
+
+// Fortsetzungspunkt für inkrementelle Abfragen: "<datei>.<satz>", z.B. "12.340"
+static String formatCursor(const LogCursor& c) {
+  char buf[24];
+  snprintf(buf, sizeof(buf), "%d.%lu", c.seg, (unsigned long)c.rec);
+  return String(buf);
+}
+
+static bool parseCursor(const String& s, LogCursor& out) {
+  const char* p = s.c_str();
+  char* end;
+  const long seg = strtol(p, &end, 10);
+  if (end == p || *end != '.' || seg < 0) return false;
+  p = end + 1;
+  const unsigned long rec = strtoul(p, &end, 10);
+  if (end == p || *end) return false;
+  out.seg = (int)seg;
+  out.rec = (uint32_t)rec;
+  return true;
+}
+
+// Manifest aus scripts/www_assets.py laden: {"assets":[{uri,file,etag,type},...]}
+bool WebServerMgr::loadAssetManifest() {
+  File f = LittleFS.open(kAssetManifestPath, "r");
+  if (!f) return false;
+  DynamicJsonDocument doc(2048);
+  DeserializationError err = deserializeJson(doc, f);
+  f.close();
+  if (err) {
+    Serial.printf("[WEB] %s: %s\n", kAssetManifestPath, err.c_str());
+    return false;
+  }
+
+  _assetCount = 0;
+  for (JsonObject a : doc["assets"].as<JsonArray>()) {
+    if (_assetCount >= kMaxAssets) break;
+    StaticAsset& s = _assets[_assetCount];
+    s.uri  = a["uri"]  | "";
+    s.file = a["file"] | "";
+    s.type = a["type"] | "application/octet-stream";
+    s.etag = String("\"") + (a["etag"] | "") + "\"";
+    // HTML immer revalidieren (304), CSS/JS sind per ?v=<hash> versioniert
+    s.immutable = !s.type.startsWith("text/html");
+    if (s.uri.length() && s.file.length()) _assetCount++;
+  }
+  return _assetCount > 0;
+}
+
+// Antwortet aus dem RAM mit 304, solange der Browser den aktuellen ETag hat;
+// sonst wird die gzip-Datei unverändert gestreamt (Content-Encoding setzt streamFile)
+void WebServerMgr::handleStaticAsset(const StaticAsset& a) {
+  const char* cache = a.immutable ? "public, max-age=31536000, immutable" : "no-cache";
+
+  const String inm = _server.header("If-None-Match");
+  if (inm.length() && (inm.indexOf(a.etag) >= 0 || inm == "*")) {
+    _server.sendHeader("ETag", a.etag);
+    _server.sendHeader("Cache-Control", cache);
+    _server.send(304);
+    return;
+  }
+
+  File f = LittleFS.open(a.file, "r");
+  if (!f) {
+    _server.send(500, "text/plain", "asset open failed");
+    return;
+  }
+  _server.sendHeader("ETag", a.etag);
+  _server.sendHeader("Cache-Control", cache);
+  _server.streamFile(f, a.type);
+  f.close();
+}
+
 void WebServerMgr::serveStaticFiles() {
+  if (loadAssetManifest()) {
+    for (size_t i = 0; i < _assetCount; ++i) {
+      const StaticAsset* a = &_assets[i];
+      _server.on(a->uri, HTTP_GET, [this, a]() { handleStaticAsset(*a); });
+      if (a->uri == "/index.html") {
+        _server.on("/", HTTP_GET, [this, a]() { handleStaticAsset(*a); });
+      }
+    }
+    Serial.printf("[WEB] %u Assets aus %s\n", (unsigned)_assetCount, kAssetManifestPath);
+    return;
+  }
+
+  // Fallback: unkomprimiertes data/www (ohne Build-Schritt hochgeladen)
   // "/" explizit bedienen und _server verwenden (nicht currentServer)
   _server.on("/", HTTP_GET, [this]() {
     const char* p = "/www/index.html";
@@ -38,10 +136,19 @@ void WebServerMgr::serveStaticFiles() {
   _server.serveStatic("/mqtt.js",       LittleFS, "/www/mqtt.js");
 }
 
-void WebServerMgr::begin(const Measurement* latest, DataLogger* logger, MqttClientMgr* mqtt) {
+void WebServerMgr::begin(const Measurement* latest, DataLogger* logger, MqttClientMgr* mqtt, EnergyMeter* energy,
+                         LoopMetrics* metrics, const SensorINA219* sensor, EventDetector* events) {
   _latest = latest;
   _logger = logger;
   _mqtt = mqtt;
+  _energy = energy;
+  _metrics = metrics;
+  _sensor = sensor;
+  _events = events;
+
+  // If-None-Match für die ETags der statischen Dateien mitschneiden
+  static const char* headerKeys[] = { "If-None-Match" };
+  _server.collectHeaders(headerKeys, 1);
 
   // --- Statische Dateien explizit registrieren ---
   serveStaticFiles();
@@ -49,11 +156,22 @@ void WebServerMgr::begin(const Measurement* latest, DataLogger* logger, MqttClie
   // --- API-Routen ---
   _server.on("/api/health", HTTP_GET, [this]() { handleHealth(); });
   _server.on("/api/measure/latest", HTTP_GET, [this]() { handleLatest(); });
+  _server.on("/api/live", HTTP_GET, [this]() { handleLive(); });
+  _server.on("/api/energy/reset", HTTP_POST, [this]() { handleEnergyReset(); });
+  _server.on("/api/metrics", HTTP_GET, [this]() { handleMetrics(); });
+  _server.on("/api/metrics/reset", HTTP_POST, [this]() { handleMetricsReset(); });
   _server.on("/api/logs", HTTP_GET, [this]() { handleLogsList(); });
   _server.on("/api/logs/download", HTTP_GET, [this]() { handleLogsDownload(); });
   _server.on("/api/logs/download_all", HTTP_GET, [this]() { handleLogsDownloadAll(); });
   _server.on("/api/logs/range", HTTP_GET, [this]() { handleLogsRange(); }); // für Grafikseite
+  _server.on("/api/logs/agg", HTTP_GET, [this]() { handleLogsAgg(); });
+  _server.on("/api/logs/stats", HTTP_GET, [this]() { handleLogsStats(); });
   _server.on("/api/logs/clear", HTTP_POST, [this]() { handleLogsClear(); });
+  _server.on("/api/logs/config", HTTP_GET, [this]() { handleLogsConfigGet(); });
+  _server.on("/api/logs/config", HTTP_POST, [this]() { handleLogsConfigSave(); });
+  _server.on("/api/events", HTTP_GET, [this]() { handleEvents(); });
+  _server.on("/api/events/rules", HTTP_GET, [this]() { handleEventRulesGet(); });
+  _server.on("/api/events/rules", HTTP_POST, [this]() { handleEventRulesSave(); });
   _server.on("/api/mqtt/config", HTTP_GET, [this]() { handleMqttGet(); });
   _server.on("/api/mqtt/config", HTTP_POST, [this]() { handleMqttSave(); });
   _server.on("/api/device/info", HTTP_GET, [this]() { handleDeviceInfo(); });
@@ -68,6 +186,8 @@ void WebServerMgr::begin(const Measurement* latest, DataLogger* logger, MqttClie
 
 void WebServerMgr::loop() {
   _server.handleClient();
+  pumpStreams();
+  pumpLive();
 }
 
 void WebServerMgr::handleHealth() {
@@ -82,7 +202,13 @@ void WebServerMgr::handleLatest() {
     _server.send(500, "application/json", "{\"error\":\"no data\"}");
     return;
   }
-  StaticJsonDocument<256> doc;
+  String out;
+  latestJson(out);
+  _server.send(200, "application/json", out);
+}
+
+void WebServerMgr::latestJson(String& out) const {
+  StaticJsonDocument<768> doc;
   doc["epoch"]   = (uint32_t)_latest->epoch;
   doc["ms"]      = _latest->ms;
   doc["busV"]    = _latest->busV;
@@ -90,31 +216,531 @@ void WebServerMgr::handleLatest() {
   doc["powermW"] = _latest->powermW;
   doc["shuntmV"] = _latest->shuntmV;
   doc["loadV"]   = _latest->loadV;
-  String out; serializeJson(doc, out);
+  // Statistik des letzten Logintervalls (schnelle Abtastung)
+  doc["samples"]    = _latest->samples;
+  doc["busMinV"]    = _latest->busMinV;
+  doc["busMaxV"]    = _latest->busMaxV;
+  doc["currMinmA"]  = _latest->currMinmA;
+  doc["currMaxmA"]  = _latest->currMaxmA;
+  doc["powerMinmW"] = _latest->powerMinmW;
+  doc["powerMaxmW"] = _latest->powerMaxmW;
+  doc["energymWh"]  = _latest->energymWh;
+  doc["chargemAh"]  = _latest->chargemAh;
+  // Zählerstände (Sitzung / heute / gesamt)
+  if (_energy) {
+    JsonObject e = doc.createNestedObject("energy");
+    e["sessionmWh"]   = _energy->session().mWh;
+    e["sessionmAh"]   = _energy->session().mAh;
+    e["sessionSince"] = _energy->sessionStart();
+    e["todaymWh"]     = _energy->today().mWh;
+    e["todaymAh"]     = _energy->today().mAh;
+    e["totalmWh"]     = _energy->total().mWh;
+    e["totalmAh"]     = _energy->total().mAh;
+  }
+  serializeJson(doc, out);
+}
+
+// ---- Live-Stream ----
+// Antwort ohne Länge und ohne Chunks (Connection: close): der Browser liest
+// Ereignisse, bis einer die Verbindung schließt. EventSource verbindet sich
+// danach selbst neu; bei 503 (alle Plätze belegt) nicht.
+
+void WebServerMgr::handleLive() {
+  if (!_latest) {
+    _server.send(500, "application/json", "{\"error\":\"no data\"}");
+    return;
+  }
+  LiveClient* c = nullptr;
+  for (LiveClient& l : _live) {
+    if (!l.active) { c = &l; break; }
+  }
+  if (!c) {
+    _server.sendHeader("Retry-After", "10");
+    _server.send(503, "text/plain", "busy");
+    return;
+  }
+
+  static const char head[] =
+      "HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\nCache-Control: no-store\r\n"
+      "Connection: close\r\n\r\nretry: 5000\n\n";
+  *c = LiveClient();
+  c->client = _server.client(); // eigene Referenz hält die Verbindung nach dem Handler offen
+  c->client.setNoDelay(true);
+  if (c->client.write((const uint8_t*)head, sizeof(head) - 1) != sizeof(head) - 1) {
+    c->client = WiFiClient();
+    return;
+  }
+  c->active = true;
+  c->raw = (getParam(_server, "raw") == "1") && _sensor;
+  if (c->raw) c->rawPos = _sensor->rawHead();
+  c->pending = (_latest->samples > 0); // letzter Stand sofort
+  c->lastSend = c->lastRaw = millis();
+  Serial.printf("[live] client %s%s\n", c->client.remoteIP().toString().c_str(), c->raw ? " (raw)" : "");
+}
+
+size_t WebServerMgr::liveClients() const {
+  size_t n = 0;
+  for (const LiveClient& c : _live) {
+    if (c.active) n++;
+  }
+  return n;
+}
+
+void WebServerMgr::closeLive(LiveClient& c, const char* reason) {
+  Serial.printf("[live] %s, %u raw dropped\n", reason, (unsigned)c.dropped);
+  c.client = WiFiClient();
+  c.active = false;
+}
+
+// Rohwerte seit dem letzten Ereignis als
+//   event: raw / data: {"dt":50,"v":[V,...],"i":[mA,...]}
+// false = Client geschlossen
+bool WebServerMgr::sendLiveRaw(LiveClient& c) {
+  SensorINA219::RawSample buf[kLiveRawBatch];
+  const size_t n = _sensor->readRaw(c.rawPos, buf, kLiveRawBatch);
+  if (n == 0) return true;
+
+  char ev[64 + kLiveRawBatch * 20];
+  size_t len = snprintf(ev, sizeof(ev), "event: raw\ndata: {\"dt\":%u,\"v\":[", (unsigned)_sensor->periodMs());
+  for (size_t k = 0; k < n; ++k) {
+    len += snprintf(ev + len, sizeof(ev) - len, k ? ",%.3f" : "%.3f", SensorINA219::busV(buf[k]));
+  }
+  len += snprintf(ev + len, sizeof(ev) - len, "],\"i\":[");
+  for (size_t k = 0; k < n; ++k) {
+    len += snprintf(ev + len, sizeof(ev) - len, k ? ",%.1f" : "%.1f", _sensor->currentmA(buf[k]));
+  }
+  len += snprintf(ev + len, sizeof(ev) - len, "]}\n\n");
+  if (len >= sizeof(ev)) return true; // kann bei kLiveRawBatch nicht passieren
+
+  if (c.client.availableForWrite() < len) {
+    c.dropped += n;
+    return true;
+  }
+  if (c.client.write((const uint8_t*)ev, len) != len) {
+    closeLive(c, "write failed");
+    return false;
+  }
+  c.lastSend = millis();
+  return true;
+}
+
+void WebServerMgr::pumpLive() {
+  if (!_latest) return;
+  // neues Logintervall: allen Clients vormerken, JSON erst bei Bedarf und nur einmal
+  if (_latest->samples && _latest->ms != _liveMs) {
+    _liveMs = _latest->ms;
+    for (LiveClient& c : _live) c.pending = c.active;
+  }
+  String ev;
+
+  for (LiveClient& c : _live) {
+    if (!c.active) continue;
+    if (!c.client.connected()) { closeLive(c, "client gone"); continue; }
+
+    if (c.pending) {
+      if (ev.length() == 0) {
+        String json;
+        latestJson(json);
+        ev.reserve(json.length() + 24);
+        ev = F("event: measure\ndata: ");
+        ev += json;
+        ev += F("\n\n");
+      }
+      if (c.client.availableForWrite() >= ev.length()) {
+        if (c.client.write((const uint8_t*)ev.c_str(), ev.length()) != ev.length()) {
+          closeLive(c, "write failed");
+          continue;
+        }
+        c.pending = false;
+        c.lastSend = millis();
+      }
+    }
+
+    if (c.raw && millis() - c.lastRaw >= kLiveRawMs) {
+      c.lastRaw = millis();
+      if (!sendLiveRaw(c)) continue;
+    }
+
+    if (millis() - c.lastSend >= kLiveKeepAliveMs) {
+      // nichts geht mehr hinaus: Client hängt
+      if (c.client.availableForWrite() < 3) { closeLive(c, "stalled"); continue; }
+      c.client.write((const uint8_t*)":\n\n", 3);
+      c.lastSend = millis();
+    }
+  }
+}
+
+void WebServerMgr::handleEnergyReset() {
+  if (!_energy) {
+    _server.send(500, "application/json", "{\"ok\":false,\"error\":\"no energy meter\"}");
+    return;
+  }
+  _energy->resetSession();
+  _server.send(200, "application/json", "{\"ok\":true}");
+}
+
+// Laufzeit- und Ressourcenmetriken: JSON (Standard) oder ?format=prometheus
+void WebServerMgr::handleMetrics() {
+  if (!_metrics) {
+    _server.send(500, "application/json", "{\"error\":\"no metrics\"}");
+    return;
+  }
+  const LoopMetrics& m = *_metrics;
+  const LogIoStats& io = LogStore::io();
+  const uint32_t heapFree = ESP.getFreeHeap();
+  const uint32_t heapBlock = ESP.getMaxFreeBlockSize();
+  const uint8_t heapFrag = ESP.getHeapFragmentation();
+  const uint32_t flushAvg = io.flushes ? (uint32_t)(io.flushSumUs / io.flushes) : 0;
+
+  if (getParam(_server, "format") == "prometheus") {
+    String out;
+    out.reserve(4096);
+    auto add = [&out](const char* fmt, auto... args) {
+      char line[128];
+      snprintf(line, sizeof(line), fmt, args...);
+      out += line;
+    };
+
+    add("# TYPE pdlogger_stage_duration_us summary\n");
+    for (uint8_t i = 0; i < LoopMetrics::kStages; ++i) {
+      const LoopMetrics::Stat& st = m.stage((LoopMetrics::Stage)i);
+      const char* name = LoopMetrics::stageName((LoopMetrics::Stage)i);
+      add("pdlogger_stage_duration_us{stage=\"%s\",quantile=\"0.5\"} %u\n", name, (unsigned)st.percentile(50));
+      add("pdlogger_stage_duration_us{stage=\"%s\",quantile=\"0.99\"} %u\n", name, (unsigned)st.percentile(99));
+      add("pdlogger_stage_duration_us_sum{stage=\"%s\"} %.0f\n", name, (double)st.sumUs);
+      add("pdlogger_stage_duration_us_count{stage=\"%s\"} %u\n", name, (unsigned)st.count);
+    }
+    add("# TYPE pdlogger_stage_duration_max_us gauge\n");
+    for (uint8_t i = 0; i < LoopMetrics::kStages; ++i) {
+      add("pdlogger_stage_duration_max_us{stage=\"%s\"} %u\n",
+          LoopMetrics::stageName((LoopMetrics::Stage)i), (unsigned)m.stage((LoopMetrics::Stage)i).maxUs);
+    }
+    const LoopMetrics::Stat& late = m.lateness();
+    add("# TYPE pdlogger_sample_late_us summary\n");
+    add("pdlogger_sample_late_us{quantile=\"0.99\"} %u\n", (unsigned)late.percentile(99));
+    add("pdlogger_sample_late_us_sum %.0f\n", (double)late.sumUs);
+    add("pdlogger_sample_late_us_count %u\n", (unsigned)late.count);
+    add("# TYPE pdlogger_sample_late_max_us gauge\npdlogger_sample_late_max_us %u\n", (unsigned)late.maxUs);
+    add("# TYPE pdlogger_heap_free_bytes gauge\npdlogger_heap_free_bytes %u\n", (unsigned)heapFree);
+    add("# TYPE pdlogger_heap_min_free_bytes gauge\npdlogger_heap_min_free_bytes %u\n", (unsigned)m.heapMin());
+    add("# TYPE pdlogger_heap_max_block_bytes gauge\npdlogger_heap_max_block_bytes %u\n", (unsigned)heapBlock);
+    add("# TYPE pdlogger_heap_fragmentation_percent gauge\npdlogger_heap_fragmentation_percent %u\n", (unsigned)heapFrag);
+    add("# TYPE pdlogger_sensor_errors_total counter\npdlogger_sensor_errors_total %u\n", (unsigned)m.sensorErrors());
+    add("# TYPE pdlogger_sensor_overruns_total counter\npdlogger_sensor_overruns_total %u\n", (unsigned)m.sensorOverruns());
+    add("# TYPE pdlogger_fs_ops_total counter\n");
+    add("pdlogger_fs_ops_total{op=\"open\"} %u\n", (unsigned)io.opens);
+    add("pdlogger_fs_ops_total{op=\"read\"} %u\n", (unsigned)io.reads);
+    add("pdlogger_fs_ops_total{op=\"write\"} %u\n", (unsigned)io.writes);
+    add("pdlogger_fs_ops_total{op=\"remove\"} %u\n", (unsigned)io.removes);
+    add("pdlogger_fs_ops_total{op=\"rotate\"} %u\n", (unsigned)io.rotations);
+    add("# TYPE pdlogger_fs_bytes_total counter\n");
+    add("pdlogger_fs_bytes_total{dir=\"read\"} %u\n", (unsigned)io.bytesRead);
+    add("pdlogger_fs_bytes_total{dir=\"write\"} %u\n", (unsigned)io.bytesWritten);
+    add("# TYPE pdlogger_fs_crc_errors_total counter\npdlogger_fs_crc_errors_total %u\n", (unsigned)io.crcErrors);
+    add("# TYPE pdlogger_fs_recovered_bytes_total counter\npdlogger_fs_recovered_bytes_total %u\n", (unsigned)io.recovered);
+    add("# TYPE pdlogger_fs_flush_max_us gauge\npdlogger_fs_flush_max_us %u\n", (unsigned)io.flushMaxUs);
+    add("# TYPE pdlogger_http_streams gauge\npdlogger_http_streams %u\n", (unsigned)activeStreams());
+    _server.send(200, "text/plain; version=0.0.4", out);
+    return;
+  }
+
+  DynamicJsonDocument doc(2048);
+  doc["uptime_s"] = millis() / 1000UL;
+  doc["window_s"] = (millis() - m.since()) / 1000UL;
+
+  auto putStat = [](JsonObject o, const LoopMetrics::Stat& st) {
+    o["n"]      = st.count;
+    o["avg_us"] = st.avgUs();
+    o["min_us"] = st.minUs;
+    o["max_us"] = st.maxUs;
+    o["p50_us"] = st.percentile(50);
+    o["p99_us"] = st.percentile(99);
+  };
+  JsonObject stages = doc.createNestedObject("stages");
+  for (uint8_t i = 0; i < LoopMetrics::kStages; ++i) {
+    putStat(stages.createNestedObject(LoopMetrics::stageName((LoopMetrics::Stage)i)),
+            m.stage((LoopMetrics::Stage)i));
+  }
+  putStat(doc.createNestedObject("sample_late"), m.lateness());
+
+  JsonObject heap = doc.createNestedObject("heap");
+  heap["free"]      = heapFree;
+  heap["min_free"]  = m.heapMin();
+  heap["max_block"] = heapBlock;
+  heap["frag"]      = heapFrag;
+
+  JsonObject sensor = doc.createNestedObject("sensor");
+  sensor["errors"]   = m.sensorErrors();
+  sensor["overruns"] = m.sensorOverruns();
+
+  JsonObject fs = doc.createNestedObject("fs");
+  fs["opens"]         = io.opens;
+  fs["reads"]         = io.reads;
+  fs["bytes_read"]    = io.bytesRead;
+  fs["writes"]        = io.writes;
+  fs["bytes_written"] = io.bytesWritten;
+  fs["flushes"]       = io.flushes;
+  fs["flush_avg_us"]  = flushAvg;
+  fs["flush_max_us"]  = io.flushMaxUs;
+  fs["rotations"]     = io.rotations;
+  fs["crc_errors"]    = io.crcErrors;
+  fs["recovered_bytes"] = io.recovered;
+  fs["removes"]       = io.removes;
+
+  doc["http"]["streams"] = activeStreams();
+
+  String out;
+  serializeJson(doc, out);
   _server.send(200, "application/json", out);
 }
 
+void WebServerMgr::handleMetricsReset() {
+  if (!_metrics) {
+    _server.send(500, "application/json", "{\"ok\":false,\"error\":\"no metrics\"}");
+    return;
+  }
+  _metrics->reset();
+  _server.send(200, "application/json", "{\"ok\":true}");
+}
+
 void WebServerMgr::handleLogsList() {
   if (!_logger) {
     _server.send(500, "application/json", "{\"error\":\"no logger\"}");
     return;
   }
   String json;
+  _logger->flush(); // Größen inkl. gepufferter Sätze
   _logger->listFilesJSON(json);
   _server.send(200, "application/json", json);
 }
 
+// ---- Log-Streams ----
+// Handler prüfen die Anfrage, schreiben den Antwortkopf direkt an den Client
+// und übergeben Quelle und Position an einen freien Slot. loop() erzeugt dann
+// je Durchlauf höchstens einen Chunk pro Slot und schreibt ihn nur, wenn er
+// ohne Warten in den TCP-Sendepuffer passt.
+
+WebServerMgr::LogStream* WebServerMgr::openStream(const char* tag, LogStore& src, const LogCursor& from,
+                                                  int lastSeg, const char* contentType,
+                                                  const String& headers) {
+  LogStream* s = nullptr;
+  for (LogStream& c : _streams) {
+    if (c.kind == LogStream::Idle) { s = &c; break; }
+  }
+  if (!s) {
+    _server.sendHeader("Retry-After", "2");
+    _server.send(503, "text/plain", "busy");
+    return nullptr;
+  }
+
+  // Kopf selbst senden: _server.send() würde die Antwort nach dem Handler abschließen
+  String head;
+  head.reserve(160 + headers.length());
+  head += F("HTTP/1.1 200 OK\r\nContent-Type: ");
+  head += contentType;
+  head += F("\r\nTransfer-Encoding: chunked\r\nCache-Control: no-store\r\nConnection: close\r\n");
+  head += headers;
+  head += F("\r\n");
+
+  *s = LogStream();
+  s->client = _server.client(); // eigene Referenz hält die Verbindung nach dem Handler offen
+  s->client.setNoDelay(true);
+  if (s->client.write((const uint8_t*)head.c_str(), head.length()) != head.length()) {
+    s->client = WiFiClient();
+    return nullptr;
+  }
+  s->tag = tag;
+  s->kind = LogStream::Records;
+  s->reader = LogReader(src, from, lastSeg);
+  s->lastSend = millis();
+  return s;
+}
+
+size_t WebServerMgr::activeStreams() const {
+  size_t n = 0;
+  for (const LogStream& s : _streams) {
+    if (s.kind != LogStream::Idle) n++;
+  }
+  return n;
+}
+
+bool WebServerMgr::LogStream::enter(uint32_t epoch) {
+  if (epoch < t0) return false; // vor dem Fenster (auch epoch 0, nicht synchron)
+  const uint32_t bt = t0 + (epoch - t0) / width * width;
+  if (bucket.n && bt != bucket.t) emit();
+  if (bucket.n == 0) bucket.t = bt;
+  return true;
+}
+
+void WebServerMgr::LogStream::emit() {
+  if (bucket.n == 0) return;
+  fill += bucket.formatCSV(data() + fill, room());
+  bucket.n = 0;
+  rows++;
+}
+
+// Füllt den Chunk-Puffer aus der Quelle, bis keine weitere Zeile sicher passt
+void WebServerMgr::produce(LogStream& s) {
+  const size_t rs = s.reader.recordSize();
+  const bool agg = (s.kind == LogStream::Agg);
+  const size_t line = agg ? LogAggregate::kMaxCSVLine : (s.binary ? rs : DataLogger::kMaxCSVLine);
+
+  while (!s.done && s.room() >= line) {
+    if (s.blkPos == s.blkCount) {
+      s.blkCount = s.reader.read(s.blk, sizeof(s.blk) / rs);
+      s.blkPos = 0;
+      if (s.blkCount == 0) {
+        s.reader.close();
+        // Agg: offene Periode der Stufe und letzten Bucket anhängen (bis zu zwei Zeilen)
+        if (agg && s.room() < 2 * line) return;
+        if (agg) {
+          if (s.pending.n && s.enter(s.pending.t)) s.bucket.add(s.pending);
+          s.emit();
+        }
+        s.done = true;
+        return;
+      }
+    }
+
+    const uint8_t* p = s.blk + (size_t)s.blkPos++ * rs;
+    if (agg) {
+      if (s.tier < 0) {
+        const LogRecord& r = *reinterpret_cast<const LogRecord*>(p);
+        if (s.enter(r.epoch)) s.bucket.add(r);
+      } else {
+        const RollupRecord& r = *reinterpret_cast<const RollupRecord*>(p);
+        if (s.enter(r.epoch)) s.bucket.add(r);
+      }
+      continue;
+    }
+
+    const LogRecord& rec = *reinterpret_cast<const LogRecord*>(p);
+    // epoch 0 = Zeit nicht synchron; bei Zeitfenster zu alt -> nicht senden
+    if (s.minEpoch && rec.epoch < s.minEpoch) continue;
+    if (s.binary) {
+      memcpy(s.data() + s.fill, p, rs);
+      s.fill += rs;
+    } else {
+      s.fill += DataLogger::formatCSV(rec, s.data() + s.fill, s.room());
+    }
+    s.rows++;
+  }
+}
+
+// Stats: je Aufruf höchstens kStatsBlocks Blöcke auswerten; die Antwort (ein
+// JSON-Objekt) entsteht erst am Ende des Fensters
+void WebServerMgr::produceStats(LogStream& s) {
+  const size_t rs = sizeof(LogRecord);
+  for (size_t b = 0; b < kStatsBlocks && !s.done; ++b) {
+    const size_t n = s.reader.read(s.blk, sizeof(s.blk) / rs);
+    bool end = (n == 0);
+    for (size_t k = 0; k < n; ++k) {
+      const LogRecord& r = *reinterpret_cast<const LogRecord*>(s.blk + k * rs);
+      if (r.epoch == 0 || r.epoch < s.minEpoch) continue; // nicht synchron / vor dem Fenster
+      if (s.maxEpoch && r.epoch > s.maxEpoch) { end = true; break; }
+      s.stats.add(r);
+      s.rows++;
+    }
+    s.lastSend = millis(); // Fortschritt, auch wenn noch nichts gesendet wird
+    if (!end) continue;
+
+    s.reader.close();
+    DynamicJsonDocument doc(1024);
+    doc["from"] = s.minEpoch;
+    doc["to"]   = s.maxEpoch;
+    s.stats.toJson(doc);
+    s.fill += serializeJson(doc, s.data() + s.fill, s.room());
+    s.done = true;
+  }
+}
+
+// Schreibt den gefüllten Puffer als einen Chunk (Länge vorn, CRLF hinten);
+// false = noch kein Platz im Sendepuffer
+bool WebServerMgr::sendChunk(LogStream& s) {
+  char len[LogStream::kHead + 1];
+  const int n = snprintf(len, sizeof(len), "%X\r\n", (unsigned)s.fill);
+  char* start = s.out + LogStream::kHead - n;
+  memcpy(start, len, n);
+  memcpy(s.data() + s.fill, "\r\n", 2);
+  const size_t total = n + s.fill + 2;
+  if (s.client.availableForWrite() < total) return false;
+  if (s.client.write((const uint8_t*)start, total) != total) {
+    closeStream(s, "write failed");
+    return false;
+  }
+  s.fill = 0;
+  s.lastSend = millis();
+  return true;
+}
+
+void WebServerMgr::closeStream(LogStream& s, const char* reason) {
+  s.reader.close();
+  Serial.printf("[%s] %s, %u rows\n", s.tag, reason, (unsigned)s.rows);
+  // Referenz freigeben: lwIP sendet den Rest und schließt die Verbindung (ohne zu warten)
+  s.client = WiFiClient();
+  s.kind = LogStream::Idle;
+}
+
+void WebServerMgr::pumpStreams() {
+  for (LogStream& s : _streams) {
+    if (s.kind == LogStream::Idle) continue;
+    if (!s.client.connected()) { closeStream(s, "client gone"); continue; }
+    if (millis() - s.lastSend > kStreamTimeoutMs) { closeStream(s, "timeout"); continue; }
+
+    if (!s.done) {
+      if (s.kind == LogStream::Stats) produceStats(s);
+      else produce(s);
+    }
+    if (s.fill > 0) {
+      if (!sendChunk(s)) continue;
+      if (s.kind == LogStream::Idle) continue;
+    }
+    if (s.done && s.fill == 0) {
+      // abschließender leerer Chunk
+      if (s.client.availableForWrite() < 5) continue;
+      s.client.write((const uint8_t*)"0\r\n\r\n", 5);
+      closeStream(s, "done");
+    }
+  }
+}
+
 void WebServerMgr::handleLogsDownload() {
   if (!_logger) { _server.send(500, "text/plain", "no logger"); return; }
   String name = getParam(_server, "name");
   if (name.length() == 0) { _server.send(400, "text/plain", "Missing ?name="); return; }
   if (!name.startsWith("/logs/")) { _server.send(403, "text/plain", "forbidden"); return; }
-  if (!LittleFS.exists(name)) { _server.send(404, "text/plain", "not found"); return; }
-  File f = LittleFS.open(name, "r");
-  if (!f) { _server.send(404, "text/plain", "not found"); return; }
-  _server.sendHeader("Content-Disposition", "attachment; filename=\"" + String(f.name()) + "\"");
-  _server.streamFile(f, "text/csv");
-  f.close();
+  _logger->flush(); // gepufferte Sätze vor dem Lesen schreiben
+  LogStore& raw = _logger->raw();
+  const int pos = raw.findSegment(name);
+  if (pos < 0) { _server.send(404, "text/plain", "not found"); return; }
+
+  String base = name.substring(name.lastIndexOf('/') + 1);
+  const int index = raw.segment(pos).index;
+  LogCursor from;
+  from.seg = index;
+
+  // ?format=bin liefert Dateikopf + Sätze (gepackte Segmente entpackt), sonst CSV
+  if (getParam(_server, "format") == "bin") {
+    LogStream* s = openStream("DL", raw, from, index, "application/octet-stream",
+                              "Content-Disposition: attachment; filename=\"" + base + "\"\r\n");
+    if (!s) return;
+    LogFileHeader h;
+    memcpy(h.magic, LOG_MAGIC, sizeof(h.magic));
+    h.version = LOG_FORMAT_PLAIN; // gestreamte Sätze ohne Prüfsumme
+    h.recordSize = raw.recordSize();
+    h.flags = 0;
+    memcpy(s->data(), &h, sizeof(h));
+    s->fill = sizeof(h);
+    s->binary = true;
+    return;
+  }
+
+  int dot = base.lastIndexOf('.');
+  if (dot > 0) base = base.substring(0, dot);
+  LogStream* s = openStream("DL", raw, from, index, "text/csv",
+                            "Content-Disposition: attachment; filename=\"" + base + ".csv\"\r\n");
+  if (!s) return;
+  s->fill = strlcpy(s->data(), "epoch;bus_V;curr_mA\n", LogStream::kChunk);
 }
 
 void WebServerMgr::handleLogsDownloadAll() {
@@ -122,89 +748,34 @@ void WebServerMgr::handleLogsDownloadAll() {
   if (debug) Serial.println(F("[DL_ALL] DEBUG MODE"));
   else       Serial.println(F("[DL_ALL] start"));
 
-  // --- 1) Alle /logs/log_####.csv einsammeln ---
-  struct Item { int idx; String path; size_t size; };
-  Item items[64];
-  size_t n = 0;
-
-  auto parseIndexFromBase = [](const String& base, int& outIdx) -> bool {
-    // erwartet "log_0003.csv" oder allgemein "<prefix>_<####>.csv"
-    int us  = base.indexOf('_');
-    int dot = base.lastIndexOf('.');
-    if (us < 0 || dot < 0 || dot <= us + 1) return false;
-    String idxStr = base.substring(us + 1, dot);
-    if (idxStr.length() == 0) return false;
-    for (unsigned i = 0; i < idxStr.length(); ++i)
-      if (idxStr[i] < '0' || idxStr[i] > '9') return false;
-    outIdx = idxStr.toInt();
-    return true;
-  };
-
-  Dir dir = LittleFS.openDir("/logs");
-  while (dir.next()) {
-    yield(); // WDT während Verzeichnislauf
-
-    String path = dir.fileName();  // kann "/logs/log_0000.csv" oder "log_0000.csv" liefern
-    // fehlenden führenden Slash korrigieren (zur Sicherheit)
-    if (!path.startsWith("/")) path = "/" + path;
-    // sicherstellen, dass "/logs/" drin ist:
-    if (!path.startsWith("/logs/")) path = String("/logs/") + path.substring(path.lastIndexOf('/') + 1);
-
-    int slash = path.lastIndexOf('/');
-    String base = (slash >= 0) ? path.substring(slash + 1) : path;
-    int idx;
-    if (!parseIndexFromBase(base, idx)) {
-      if (debug) Serial.printf("[DL_ALL] skip (name): %s\n", path.c_str());
-      continue;
-    }
+  if (!_logger) { _server.send(500, "text/plain", "no logger"); return; }
 
-    // Größe ermitteln
-    size_t sz = 0;
-    File f = LittleFS.open(path, "r");
-    if (f) { sz = f.size(); f.close(); }
-
-    if (n < 64) {
-      items[n].idx  = idx;
-      items[n].path = path;
-      items[n].size = sz;
-      if (debug) Serial.printf("[DL_ALL] add idx=%d path=%s size=%u\n", idx, path.c_str(), (unsigned)sz);
-      n++;
-    }
-  }
+  // gepufferte Sätze vor dem Lesen schreiben
+  _logger->flush();
 
+  // --- 1) Dateien aus dem Segment-Index (aufsteigend sortiert) ---
+  LogStore& raw = _logger->raw();
+  const size_t n = raw.segmentCount();
   if (n == 0) {
     Serial.println(F("[DL_ALL] no logs found"));
     _server.send(404, "text/plain", "no logs");
     return;
   }
 
-  // --- 2) sortieren (aufsteigend) ---
-  for (size_t i = 1; i < n; ++i) {
-    Item key = items[i];
-    size_t j = i;
-    while (j > 0 && items[j-1].idx > key.idx) {
-      items[j] = items[j-1];
-      j--;
-    }
-    items[j] = key;
-  }
-  if (debug) {
-    for (size_t i = 0; i < n; ++i) {
-      Serial.printf("[DL_ALL] order[%u]: idx=%d path=%s size=%u\n",
-                    (unsigned)i, items[i].idx, items[i].path.c_str(), (unsigned)items[i].size);
-    }
-  }
-
-  // --- 3) DEBUG-Text statt Download? ---
+  // --- 2) DEBUG-Text statt Download? ---
   if (debug) {
     String diag;
     diag.reserve(1024);
     diag += "DOWNLOAD ALL – DEBUG\n";
     for (size_t i = 0; i < n; ++i) {
-      diag += String(i) + ": idx=" + String(items[i].idx) +
-              " path=" + items[i].path +
-              " size=" + String(items[i].size) + "\n";
-      bool ex = LittleFS.exists(items[i].path);
+      const LogSegment& seg = raw.segment(i);
+      const String path = raw.segmentPath(i);
+      diag += String(i) + ": idx=" + String(seg.index) +
+              " path=" + path +
+              " size=" + String(seg.size) +
+              " first=" + String(seg.firstEpoch) +
+              " last=" + String(seg.lastEpoch) + "\n";
+      bool ex = LittleFS.exists(path);
       diag += "  exists=" + String(ex ? "true" : "false") + "\n";
       yield();
     }
@@ -213,179 +784,161 @@ void WebServerMgr::handleLogsDownloadAll() {
     return;
   }
 
-  // --- 4) CSV streamen (korrekte Chunked-Übertragung) ---
-  _server.setContentLength(CONTENT_LENGTH_UNKNOWN);
-  _server.sendHeader("Content-Disposition", "attachment; filename=\"pd_logger_all.csv\"");
-  _server.sendHeader("Connection", "close"); // Safari-Freund
-  _server.send(200, "text/csv", "");
-  _server.sendContent("epoch;bus_V;curr_mA\n"); // Header einmal
-
-  char buf[512];
-  size_t total = 0;
-
-  for (size_t k = 0; k < n; ++k) {
-    const String& p = items[k].path;
-    if (!LittleFS.exists(p)) {
-      if (debug) Serial.printf("[DL_ALL] WARN not exists: %s\n", p.c_str());
-      continue;
-    }
-    File f = LittleFS.open(p, "r");
-    if (!f) {
-      if (debug) Serial.printf("[DL_ALL] WARN open failed: %s\n", p.c_str());
-      continue;
-    }
-
-    // Headerzeile verwerfen
-    (void)f.readStringUntil('\n');
-
-    // Rest in Chunks senden (mit korrekten Chunk-Headern)
-    while (f.available()) {
-      size_t r = f.readBytes(buf, sizeof(buf));
-      if (r) {
-        // sendContent_P sendet korrekt als Chunk (ohne String-Kopie)
-        _server.sendContent_P(buf, r);
-        total += r;
-      }
-      yield(); // WDT füttern
-    }
-    f.close();
-  }
-
-  // finaler leerer Chunk -> beendet die Antwort sauber
-  _server.sendContent("");
-
-  Serial.printf("[DL_ALL] done, streamed %u bytes (payload)\n", (unsigned)total);
+  // --- 3) Sätze als CSV streamen (chunked, in loop()) ---
+  LogStream* s = openStream("DL_ALL", raw, LogCursor(), 0x7FFFFFFF, "text/csv",
+                            F("Content-Disposition: attachment; filename=\"pd_logger_all.csv\"\r\n"));
+  if (!s) return;
+  s->fill = strlcpy(s->data(), "epoch;bus_V;curr_mA\n", LogStream::kChunk); // Header einmal
 }
 
 void WebServerMgr::handleLogsRange() {
   const bool debug = _server.hasArg("debug");
-  String secArg = _server.hasArg("sec") ? _server.arg("sec") : String("max");
-
-  // 1) Zeitfenster bestimmen
-  time_t nowEpoch = time(nullptr);
-  if (nowEpoch < 100000) nowEpoch = 0; // falls NTP noch nicht synchron
 
-  long windowSec = 0; // 0 => alles
-  if (!secArg.equalsIgnoreCase("max")) {
-    windowSec = secArg.toInt(); // ungültig -> 0
-    if (windowSec < 0) windowSec = 0;
+  // 1) Zeitfenster bestimmen; ?since=<epoch> liefert nur jüngere Sätze
+  uint32_t nowEpoch;
+  uint32_t minEpoch = windowStart(_server, nowEpoch);
+  if (_server.hasArg("since")) {
+    const uint32_t since = strtoul(_server.arg("since").c_str(), nullptr, 10);
+    if (since + 1 > minEpoch) minEpoch = since + 1;
   }
-  time_t minEpoch = (nowEpoch > 0 && windowSec > 0) ? (nowEpoch - windowSec) : 0;
 
   if (debug) {
-    Serial.printf("[RANGE] secArg=%s now=%ld min=%ld\n",
-                  secArg.c_str(), (long)nowEpoch, (long)minEpoch);
+    Serial.printf("[RANGE] sec=%s now=%lu min=%lu\n", _server.arg("sec").c_str(),
+                  (unsigned long)nowEpoch, (unsigned long)minEpoch);
   }
 
-  // 2) Log-Dateien einsammeln & sortieren (wie bei Download_All)
-  struct Item { int idx; String path; };
-  Item items[64];
-  size_t n = 0;
-
-  auto parseIndexFromBase = [](const String& base, int& outIdx) -> bool {
-    int us  = base.indexOf('_');
-    int dot = base.lastIndexOf('.');
-    if (us < 0 || dot < 0 || dot <= us + 1) return false;
-    String idxStr = base.substring(us + 1, dot);
-    if (idxStr.length() == 0) return false;
-    for (unsigned i = 0; i < idxStr.length(); ++i)
-      if (idxStr[i] < '0' || idxStr[i] > '9') return false;
-    outIdx = idxStr.toInt();
-    return true;
-  };
-
-  Dir dir = LittleFS.openDir("/logs");
-  while (dir.next()) {
-    yield();
-    String path = dir.fileName();
-    if (!path.startsWith("/")) path = "/" + path;
-    if (!path.startsWith("/logs/")) {
-      int slash = path.lastIndexOf('/');
-      path = String("/logs/") + (slash >= 0 ? path.substring(slash + 1) : path);
-    }
-    int slash = path.lastIndexOf('/');
-    String base = (slash >= 0) ? path.substring(slash + 1) : path;
+  if (!_logger) { _server.send(500, "text/plain", "no logger"); return; }
 
-    int idx;
-    if (!parseIndexFromBase(base, idx)) continue;
-    if (n < 64) { items[n].idx = idx; items[n].path = path; n++; }
-  }
+  // gepufferte Sätze vor dem Lesen schreiben
+  _logger->flush();
 
+  // 2) Startposition über den Segment-Index: ältere Dateien überspringen,
+  //    im ersten relevanten Segment binär zum ersten Satz >= minEpoch springen
+  LogStore& raw = _logger->raw();
+  const size_t n = raw.segmentCount();
   if (n == 0) {
     _server.send(404, "text/plain", "no logs");
     return;
   }
-
-  for (size_t i = 1; i < n; ++i) {
-    Item key = items[i];
-    size_t j = i;
-    while (j > 0 && items[j-1].idx > key.idx) { items[j] = items[j-1]; j--; }
-    items[j] = key;
+  LogCursor start;
+  bool any;
+
+  // ?cursor=<X-Log-Cursor der letzten Antwort>: nur was seitdem geschrieben
+  // wurde. Ist die Stelle wegrotiert oder gelöscht, gibt es wieder das ganze
+  // Fenster und X-Log-Reset: 1 (der Client verwirft dann seine Daten).
+  LogCursor from;
+  const bool incremental = _server.hasArg("cursor") && parseCursor(_server.arg("cursor"), from) &&
+                           raw.contains(from);
+  if (incremental) {
+    start = from;
+    any = true;
+  } else {
+    any = raw.findFirst(minEpoch, start);
   }
+  // Ende jetzt festlegen: was während des Sendens dazukommt, gehört zur nächsten Abfrage
+  const LogCursor end = raw.endCursor();
 
   if (debug) {
-    Serial.printf("[RANGE] %u files\n", (unsigned)n);
-    for (size_t i = 0; i < n; ++i) Serial.printf("  [%u] %s\n", (unsigned)i, items[i].path.c_str());
+    Serial.printf("[RANGE] %u files, start seg=%d rec=%u end seg=%d rec=%u\n",
+                  (unsigned)n, start.seg, (unsigned)start.rec, end.seg, (unsigned)end.rec);
   }
 
-  // 3) CSV streamen (nur Zeilen >= minEpoch), korrekter Chunked-Ende
-  _server.setContentLength(CONTENT_LENGTH_UNKNOWN);
-  _server.sendHeader("Content-Type", "text/csv; charset=utf-8");
-  _server.sendHeader("Cache-Control", "no-store");
-  _server.sendHeader("Connection", "close");
-  _server.send(200, "text/csv", "");
-  _server.sendContent("epoch;bus_V;curr_mA\n");
-
-  size_t outCount = 0;
-  for (size_t k = 0; k < n; ++k) {
-    File f = LittleFS.open(items[k].path, "r");
-    if (!f) continue;
-
-    // Header der Datei weg
-    (void)f.readStringUntil('\n');
-
-    while (f.available()) {
-      String line = f.readStringUntil('\n'); // enthält kein '\n'
-      if (line.length() == 0) continue;
-
-      // CR am Zeilenende entfernen
-      if (line.length() && line[line.length()-1] == '\r') {
-        line.remove(line.length()-1);
-      }
-
-      // epoch als erstes Feld extrahieren (bis ';')
-      int sc = line.indexOf(';');
-      if (sc <= 0) continue; // ungültige Zeile
-      String eStr = line.substring(0, sc);
-
-      // schnelle Prüfung auf Zahl (erste Stelle)
-      char c0 = eStr[0];
-      if (c0 < '0' || c0 > '9') {
-        // evtl. "nan" etc. -> überspringen
-        continue;
-      }
+  String headers;
+  headers += "X-Log-Cursor: " + formatCursor(end) + "\r\n";
+  if (_server.hasArg("cursor") && !incremental) headers += F("X-Log-Reset: 1\r\n");
+
+  // 3) Sätze >= minEpoch streamen: CSV (Standard) oder ?format=bin als rohe 8-Byte-Sätze
+  const bool binary = getParam(_server, "format") == "bin";
+  LogStream* s = openStream("RANGE", raw, start, end.seg,
+                            binary ? "application/octet-stream" : "text/csv; charset=utf-8", headers);
+  if (!s) return;
+  s->reader = LogReader(raw, start, end.seg, end.rec);
+  s->binary = binary;
+  s->minEpoch = minEpoch;
+  if (!binary) s->fill = strlcpy(s->data(), "epoch;bus_V;curr_mA\n", LogStream::kChunk);
+  // nichts Neues seit dem Cursor: Datei gar nicht erst öffnen
+  if (!any || (incremental && start.seg == end.seg && start.rec == end.rec)) s->done = true;
+}
 
-      // epoch vergleichen, wenn gefordert
-      if (minEpoch > 0) {
-        long e = eStr.toInt();
-        if (e < (long)minEpoch) {
-          // zu alt -> nicht senden
-          continue;
-        }
-      }
+void WebServerMgr::handleLogsAgg() {
+  if (!_logger) { _server.send(500, "text/plain", "no logger"); return; }
 
-      // Senden (+ newline)
-      _server.sendContent(line + "\n");
-      outCount++;
-      yield();
-    }
-    f.close();
-    yield();
+  // Zeitfenster und Auflösung (Anzahl Buckets ~ Pixelbreite des Diagramms)
+  uint32_t nowEpoch;
+  const uint32_t minEpoch = windowStart(_server, nowEpoch);
+  long points = _server.hasArg("points") ? _server.arg("points").toInt() : 600;
+  points = constrain(points, 10L, 2000L);
+
+  _logger->flush();
+  const uint32_t t0 = minEpoch ? minEpoch : _logger->firstEpoch();
+  const uint32_t t1 = max(nowEpoch, _logger->lastEpoch());
+  const uint32_t span = (t1 > t0) ? (t1 - t0 + 1) : 1;
+  uint32_t width = (span + points - 1) / points; // Sekunden pro Bucket
+
+  // Quelle: gröbste Rollup-Stufe, deren Periode in einen Bucket passt (sonst Rohdaten);
+  // Bucketbreite dann auf ein Vielfaches der Periode, damit jeder Bucket gleich viele Sätze bekommt
+  const int tier = _logger->pickTier(t0, width);
+  if (tier >= 0) {
+    const uint32_t period = _logger->tierPeriod(tier);
+    width = (width + period - 1) / period * period;
   }
+  LogStore& src = (tier < 0) ? _logger->raw() : _logger->tier(tier);
+  LogCursor start;
+  const bool any = src.findFirst(t0, start);
+  // Stand der Rohdaten: damit setzt der Client mit /api/logs/range?cursor= fort
+  const LogCursor rawEnd = _logger->raw().endCursor();
+
+  String headers;
+  headers += "X-Bucket-Seconds: " + String(width) + "\r\n";
+  headers += "X-Source-Seconds: " + String(tier < 0 ? 0 : _logger->tierPeriod(tier)) + "\r\n";
+  headers += "X-Log-Cursor: " + formatCursor(rawEnd) + "\r\n";
+  LogStream* s = openStream("AGG", src, start, 0x7FFFFFFF, "text/csv", headers);
+  if (!s) return;
+  // Stand jetzt festhalten: der Durchlauf zieht sich über viele loop(). Rollt
+  // die Stufe inzwischen über, steht die alte Periode hinter dem Ende und
+  // kommt über die Kopie von pending, die neue zählt erst beim nächsten Abruf
+  const LogCursor end = (tier < 0) ? rawEnd : src.endCursor();
+  s->reader = LogReader(src, start, end.seg, end.rec);
+  s->fill = strlcpy(s->data(),
+                    "epoch;n;bus_mV_min;bus_mV_max;bus_mV_avg;curr_mA_min;curr_mA_max;curr_mA_avg;"
+                    "power_mW_min;power_mW_max;power_mW_avg\n", LogStream::kChunk);
+
+  // Ein Durchlauf: Sätze sind zeitlich geordnet, es ist immer nur ein Bucket offen
+  s->kind = LogStream::Agg;
+  s->tier = tier;
+  s->t0 = t0;
+  s->width = width;
+  s->pending = (tier < 0) ? LogAggregate() : _logger->tierPending(tier);
+  if (!any || !t0) s->done = true;
+}
+
+// Kennzahlen eines Zeitfensters als kurzes JSON statt der ganzen CSV:
+// ?from=&to= (epoch, to fehlt = bis jetzt) oder ?sec= wie bei range. Ein
+// Durchlauf über die Rohdaten, scheibchenweise in loop() wie die anderen
+// Log-Antworten.
+void WebServerMgr::handleLogsStats() {
+  if (!_logger) { _server.send(500, "text/plain", "no logger"); return; }
 
-  // finaler leerer Chunk
-  _server.sendContent("");
-  if (debug) Serial.printf("[RANGE] sent %u rows\n", (unsigned)outCount);
+  uint32_t nowEpoch;
+  uint32_t from = windowStart(_server, nowEpoch);
+  uint32_t to = 0;
+  if (_server.hasArg("from")) from = strtoul(_server.arg("from").c_str(), nullptr, 10);
+  if (_server.hasArg("to")) to = strtoul(_server.arg("to").c_str(), nullptr, 10);
+  if (to && to < from) { _server.send(400, "text/plain", "to < from"); return; }
+
+  _logger->flush();
+  LogStore& raw = _logger->raw();
+  LogCursor start;
+  const bool any = raw.findFirst(from, start);
+  // Ende jetzt festlegen: was während des Durchlaufs dazukommt, zählt nicht mehr
+  const LogCursor end = raw.endCursor();
+  LogStream* s = openStream("STATS", raw, start, end.seg, "application/json", String());
+  if (!s) return;
+  s->reader = LogReader(raw, start, end.seg, end.rec);
+  s->kind = LogStream::Stats;
+  s->minEpoch = from;
+  s->maxEpoch = to;
+  if (!any) s->reader = LogReader(); // leeres Fenster: nur die Zusammenfassung
 }
 
 void WebServerMgr::handleLogsClear() {
@@ -399,6 +952,11 @@ void WebServerMgr::handleLogsClear() {
     return;
   }
 
+  // laufende Log-Antworten abbrechen, ihre Dateien werden gelöscht
+  for (LogStream& st : _streams) {
+    if (st.kind != LogStream::Idle) closeStream(st, "logs cleared");
+  }
+
   bool ok = _logger->clearAll();
   if (ok) {
     _server.send(200, "application/json", "{\"ok\":true}");
@@ -407,75 +965,182 @@ void WebServerMgr::handleLogsClear() {
   }
 }
 
-void WebServerMgr::handleMqttGet() {
-  StaticJsonDocument<256> doc;
-  doc["server"] = "";
-  doc["port"] = 1883;
-  doc["user"] = "";
-  doc["pass"] = "";
+// Flash-Budget: eingestellte Grenzen, Dateisystem und die daraus berechnete
+// Aufteilung je Dateisatz
+void WebServerMgr::handleLogsConfigGet() {
+  if (!_logger) {
+    _server.send(500, "application/json", "{\"error\":\"no logger\"}");
+    return;
+  }
+  StaticJsonDocument<768> doc;
+  _logger->budget().toJson(doc);
+  FSInfo fsi;
+  if (LittleFS.info(fsi)) {
+    doc["fsTotal"] = fsi.totalBytes;
+    doc["fsUsed"] = fsi.usedBytes;
+  }
+  doc["budget"] = _logger->budgetBytes();
+  JsonArray stores = doc.createNestedArray("stores");
+  for (size_t i = 0; i <= _logger->tierCount(); ++i) {
+    const LogStore& st = i ? _logger->tier(i - 1) : _logger->raw();
+    JsonObject o = stores.createNestedObject();
+    o["period"] = i ? _logger->tierPeriod(i - 1) : SAMPLE_INTERVAL_MS / 1000;
+    o["fileSize"] = st.maxFileSize();
+    o["files"] = st.maxFiles();
+    o["segments"] = st.segmentCount();
+    o["bytes"] = st.allocatedBytes();
+    o["first"] = st.firstEpoch();
+  }
+  String out;
+  serializeJson(doc, out);
+  _server.send(200, "application/json", out);
+}
 
-  if (LittleFS.exists(kMqttConfigPath)) {
-    File f = LittleFS.open(kMqttConfigPath, "r");
-    if (!f) {
-      _server.send(500, "application/json", "{\"error\":\"mqtt config open failed\"}");
-      return;
-    }
-    DeserializationError err = deserializeJson(doc, f);
-    f.close();
-    if (err) {
-      doc.clear();
-      doc["server"] = "";
-      doc["port"] = 1883;
-    }
-  } else {
-    File f = LittleFS.open(kMqttConfigPath, "w");
-    if (f) {
-      serializeJson(doc, f);
-      f.close();
-    }
+void WebServerMgr::handleLogsConfigSave() {
+  if (!_logger) {
+    _server.send(500, "application/json", "{\"ok\":false,\"error\":\"no logger\"}");
+    return;
+  }
+  const String body = _server.arg("plain");
+  if (body.length() == 0) {
+    _server.send(400, "application/json", "{\"ok\":false,\"error\":\"empty body\"}");
+    return;
   }
 
+  StaticJsonDocument<128> inDoc;
+  DeserializationError err = deserializeJson(inDoc, body);
+  if (err) {
+    _server.send(400, "application/json", "{\"ok\":false,\"error\":\"bad json\"}");
+    return;
+  }
+
+  LogBudget b;
+  const char* why = "";
+  if (!b.fromJson(inDoc, why)) {
+    _server.send(400, "application/json", String("{\"ok\":false,\"error\":\"") + why + "\"}");
+    return;
+  }
+  // ein kleineres Budget löscht sofort die ältesten Segmente
+  if (!_logger->setBudget(b)) {
+    _server.send(500, "application/json", "{\"ok\":false,\"error\":\"save failed\"}");
+    return;
+  }
+  _server.send(200, "application/json", "{\"ok\":true}");
+}
+
+// Erkannte Ereignisse als JSON-Array, aufsteigend nach Zeit: die jüngsten
+// ?limit= (Standard 50) ab ?since=<epoch>
+void WebServerMgr::handleEvents() {
+  if (!_events) {
+    _server.send(503, "application/json", "{\"error\":\"events not available\"}");
+    return;
+  }
+  const uint32_t since = strtoul(_server.arg("since").c_str(), nullptr, 10);
+  long limit = _server.hasArg("limit") ? _server.arg("limit").toInt() : 50;
+  limit = constrain(limit, 1L, (long)kMaxEvents);
+
+  std::vector<EventRecord> ev(limit);
+  const size_t n = _events->recent(since, ev.data(), ev.size());
+  String out;
+  out.reserve(2 + n * 128);
+  out += '[';
+  char line[EventDetector::kMaxJSON];
+  for (size_t k = 0; k < n; ++k) {
+    if (!EventDetector::formatJSON(ev[k], line, sizeof(line))) continue;
+    if (out.length() > 1) out += ',';
+    out += line;
+  }
+  out += ']';
+  _server.send(200, "application/json", out);
+}
+
+void WebServerMgr::handleEventRulesGet() {
+  if (!_events) {
+    _server.send(503, "application/json", "{\"error\":\"events not available\"}");
+    return;
+  }
+  DynamicJsonDocument doc(1024);
+  _events->config().toJson(doc);
+  doc["count"] = _events->count();
+  doc["dropped"] = _events->dropped();
   String out;
   serializeJson(doc, out);
   _server.send(200, "application/json", out);
 }
 
-void WebServerMgr::handleMqttSave() {
+void WebServerMgr::handleEventRulesSave() {
+  if (!_events) {
+    _server.send(503, "application/json", "{\"ok\":false,\"error\":\"events not available\"}");
+    return;
+  }
   const String body = _server.arg("plain");
   if (body.length() == 0) {
     _server.send(400, "application/json", "{\"ok\":false,\"error\":\"empty body\"}");
     return;
   }
 
-  StaticJsonDocument<256> inDoc;
+  DynamicJsonDocument inDoc(1024);
   DeserializationError err = deserializeJson(inDoc, body);
   if (err) {
     _server.send(400, "application/json", "{\"ok\":false,\"error\":\"bad json\"}");
     return;
   }
 
-  const char* server = inDoc["server"] | "";
-  int port = inDoc["port"] | 0;
-  const char* user = inDoc["user"] | "";
-  const char* pass = inDoc["pass"] | "";
-  if (port <= 0 || port > 65535) {
-    _server.send(400, "application/json", "{\"ok\":false,\"error\":\"bad port\"}");
+  EventConfig cfg;
+  const char* why = "";
+  if (!cfg.fromJson(inDoc, why)) {
+    _server.send(400, "application/json", String("{\"ok\":false,\"error\":\"") + why + "\"}");
+    return;
+  }
+  // gilt ab der nächsten Abtastung, Regelzustände beginnen neu
+  if (!_events->setConfig(cfg)) {
+    _server.send(500, "application/json", "{\"ok\":false,\"error\":\"save failed\"}");
+    return;
+  }
+  _server.send(200, "application/json", "{\"ok\":true}");
+}
+
+void WebServerMgr::handleMqttGet() {
+  if (!_mqtt) {
+    _server.send(503, "application/json", "{\"error\":\"mqtt not available\"}");
+    return;
+  }
+  StaticJsonDocument<384> doc;
+  _mqtt->config().get().toJson(doc);
+  String out;
+  serializeJson(doc, out);
+  _server.send(200, "application/json", out);
+}
+
+void WebServerMgr::handleMqttSave() {
+  if (!_mqtt) {
+    _server.send(503, "application/json", "{\"ok\":false,\"error\":\"mqtt not available\"}");
+    return;
+  }
+  const String body = _server.arg("plain");
+  if (body.length() == 0) {
+    _server.send(400, "application/json", "{\"ok\":false,\"error\":\"empty body\"}");
     return;
   }
 
-  StaticJsonDocument<256> outDoc;
-  outDoc["server"] = server;
-  outDoc["port"] = port;
-  outDoc["user"] = user;
-  outDoc["pass"] = pass;
+  StaticJsonDocument<384> inDoc;
+  DeserializationError err = deserializeJson(inDoc, body);
+  if (err) {
+    _server.send(400, "application/json", "{\"ok\":false,\"error\":\"bad json\"}");
+    return;
+  }
 
-  File f = LittleFS.open(kMqttConfigPath, "w");
-  if (!f) {
+  MqttConfig cfg;
+  const char* why = "";
+  if (!cfg.fromJson(inDoc, why)) {
+    _server.send(400, "application/json", String("{\"ok\":false,\"error\":\"") + why + "\"}");
+    return;
+  }
+  // schreibt atomar und meldet die Änderung an MqttClientMgr
+  if (!_mqtt->config().save(cfg)) {
     _server.send(500, "application/json", "{\"ok\":false,\"error\":\"save failed\"}");
     return;
   }
-  serializeJson(outDoc, f);
-  f.close();
   _server.send(200, "application/json", "{\"ok\":true}");
 }
 
@@ -5,29 +5,149 @@
 #include <ArduinoJson.h>
 #include "Measurement.h"
 #include "DataLogger.h"
+#include "EnergyMeter.h"
+#include "EventDetector.h"
+#include "LoopMetrics.h"
+#include "SensorINA219.h"
 class MqttClientMgr;
 
 class WebServerMgr {
 public:
   explicit WebServerMgr(uint16_t port = 80) : _server(port) {}
 
-  void begin(const Measurement* latest, DataLogger* logger, MqttClientMgr* mqtt);
+  void begin(const Measurement* latest, DataLogger* logger, MqttClientMgr* mqtt, EnergyMeter* energy,
+             LoopMetrics* metrics = nullptr, const SensorINA219* sensor = nullptr,
+             EventDetector* events = nullptr);
   void loop();
 
+  // Anzahl laufender Log-Antworten (Downloads, range, agg)
+  size_t activeStreams() const;
+  // Anzahl verbundener Live-Clients (/api/live)
+  size_t liveClients() const;
+
 private:
   ESP8266WebServer _server;
   const Measurement* _latest = nullptr;
   DataLogger* _logger = nullptr;
   MqttClientMgr* _mqtt = nullptr;
+  EnergyMeter* _energy = nullptr;
+  LoopMetrics* _metrics = nullptr;
+  const SensorINA219* _sensor = nullptr;
+  EventDetector* _events = nullptr;
+
+  // Statische Datei aus /www/assets.json (gzip, ETag), siehe scripts/www_assets.py
+  struct StaticAsset {
+    String uri;
+    String file;
+    String type;
+    String etag;       // mit Anführungszeichen, wie im Header
+    bool immutable = false;
+  };
+  static const size_t kMaxAssets = 16;
+  StaticAsset _assets[kMaxAssets];
+  size_t _assetCount = 0;
+
+  // Log-Antwort (chunked), die loop() scheibchenweise sendet, sobald im
+  // TCP-Sendepuffer Platz ist – lange Downloads blockieren so weder die
+  // Abtastung noch weitere Clients
+  struct LogStream {
+    enum Kind : uint8_t { Idle, Records, Agg, Stats };
+    static const size_t kChunk = 512;     // Nutzdaten je Chunk (passt in den Sendepuffer von lwIP)
+    static const size_t kHead = 8;        // Platz für die Chunk-Länge "200\r\n"
+
+    Kind kind = Idle;
+    const char* tag = "";                 // Präfix für Serial-Ausgaben
+    WiFiClient client;
+    LogReader reader;
+    bool binary = false;                  // Records: rohe Sätze statt CSV
+    bool done = false;                    // alles erzeugt, nur noch senden
+    uint32_t minEpoch = 0;                // Records/Stats: ältere Sätze überspringen
+    uint32_t maxEpoch = 0;                // Stats: Ende des Fensters (0 = offen)
+
+    // Agg: Bucket-Raster und Quelle (tier < 0 = Rohdaten)
+    int tier = -1;
+    uint32_t t0 = 0;
+    uint32_t width = 1;
+    LogAggregate bucket;
+    LogAggregate pending;                 // offene Periode der Stufe beim Aufruf (n = 0: keine)
+
+    LogStats stats;                       // Stats: Zustand des Durchlaufs
+
+    uint8_t blk[240];                     // gelesener Block (30 Roh- bzw. 10 Rollup-Sätze)
+    uint16_t blkCount = 0, blkPos = 0;
+    char out[kHead + kChunk + 2];
+    size_t fill = 0;                      // Nutzdaten in out (ab kHead)
+    size_t rows = 0;
+    unsigned long lastSend = 0;
+
+    char* data() { return out + kHead; }
+    size_t room() const { return kChunk - fill; }
+    // Agg: Bucket für epoch öffnen (false = vor dem Fenster) bzw. als CSV-Zeile ausgeben
+    bool enter(uint32_t epoch);
+    void emit();
+  };
+  static const size_t kMaxStreams = 2;
+  static const size_t kMaxEvents = 100;   // /api/events: höchstens so viele je Antwort
+  static const unsigned long kStreamTimeoutMs = 15000; // ohne Fortschritt -> abbrechen
+  static const size_t kStatsBlocks = 4;   // Stats: gelesene Blöcke je loop()-Durchlauf
+  LogStream _streams[kMaxStreams];
+
+  LogStream* openStream(const char* tag, LogStore& src, const LogCursor& from, int lastSeg,
+                        const char* contentType, const String& headers);
+  void produce(LogStream& s);
+  void produceStats(LogStream& s);
+  bool sendChunk(LogStream& s);
+  void closeStream(LogStream& s, const char* reason);
+  void pumpStreams();
+
+  // Live-Stream (Server-Sent Events): jedes neue Logintervall als Ereignis
+  // "measure" (JSON wie /api/measure/latest), mit ?raw=1 zusätzlich die
+  // Rohwerte der schnellen Abtastung gebündelt als "raw". Ein Ereignis wird
+  // nur geschrieben, wenn es ganz in den TCP-Sendepuffer passt; sonst wartet
+  // das Intervall bzw. die Rohwerte verfallen.
+  struct LiveClient {
+    bool active = false;
+    WiFiClient client;
+    bool raw = false;
+    uint16_t rawPos = 0;          // nächste Ringposition im Sensor
+    bool pending = false;         // neues Intervall noch nicht gesendet
+    uint32_t dropped = 0;         // verworfene Rohwerte (Sendepuffer voll)
+    unsigned long lastSend = 0;
+    unsigned long lastRaw = 0;
+  };
+  static const size_t kMaxLive = 2;
+  static const size_t kLiveRawBatch = 32;              // Rohwerte je Ereignis
+  static const unsigned long kLiveRawMs = 250;         // Rohwerte gebündelt alle 250 ms
+  static const unsigned long kLiveKeepAliveMs = 15000; // Kommentarzeile gegen Proxy-Timeouts
+  LiveClient _live[kMaxLive];
+  uint32_t _liveMs = 0;           // Measurement::ms des zuletzt verteilten Intervalls
+
+  void handleLive();
+  void pumpLive();
+  void closeLive(LiveClient& c, const char* reason);
+  bool sendLiveRaw(LiveClient& c);
+  void latestJson(String& out) const;
 
   void handleHealth();
   void handleLatest();
+  void handleEnergyReset();
+  void handleMetrics();
+  void handleMetricsReset();
   void handleLogsList();
   void handleLogsDownload();
   void handleLogsDownloadAll();
   void handleLogsRange();
+  void handleLogsAgg();
+  void handleLogsStats();
   void serveStaticFiles();
+  bool loadAssetManifest();
+  void handleStaticAsset(const StaticAsset& a);
   void handleLogsClear();
+  void handleLogsConfigGet();
+  void handleLogsConfigSave();
+  void handleEvents();
+  void handleEventRulesGet();
+  void handleEventRulesSave();
   void handleMqttGet();
   void handleMqttSave();
   void handleDeviceInfo();
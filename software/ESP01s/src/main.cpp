@@ -11,17 +11,22 @@
 #include "SensorINA219.h"
 #include "TimeService.h"
 #include "DataLogger.h"
+#include "EnergyMeter.h"
+#include "EventDetector.h"
+#include "LoopMetrics.h"
 #include "WebServerMgr.h"
 #include "MqttClientMgr.h"
 
 SensorINA219 sensor;
 TimeService   timeSvc;
 DataLogger    logger;
+EnergyMeter   energy;
+EventDetector events;
+LoopMetrics   metrics;
 WebServerMgr  web(80);
 MqttClientMgr mqtt;
 
 Measurement latest;
-unsigned long lastSample = 0;
 
 // --- mDNS Helper ---
 static bool mdnsRunning = false;
@@ -80,12 +85,17 @@ void setup() {
   timeSvc.begin(TZ_EU_BERLIN);
 
   Wire.begin(PIN_SDA, PIN_SCL);
-  if (!sensor.begin(Wire)) {
+  Wire.setClock(I2C_CLOCK_HZ);
+  sensor.setShuntMilliohm(SHUNT_MILLIOHM);
+  if (!sensor.begin(Wire, FAST_SAMPLE_MS, INA219_AVG_SAMPLES, SAMPLE_INTERVAL_MS)) {
     Serial.println(F("INA219 nicht gefunden – Verkabelung/Adresse prüfen!"));
   }
-  sensor.setShuntCorrection(INA219_CORR);
-  Wire.setClock(100000);
 
+  logger.setFlushPolicy(LOG_FLUSH_RECORDS, LOG_FLUSH_MS);
+  logger.setPacking(LOG_PACK_SEGMENTS);
+  logger.setConfigPath(LOG_CONFIG_PATH);
+  logger.addTier(LOG_TIER1_PREFIX, LOG_TIER1_PERIOD_S, LOG_TIER_FILE_SIZE, LOG_TIER1_FILES);
+  logger.addTier(LOG_TIER2_PREFIX, LOG_TIER2_PERIOD_S, LOG_TIER_FILE_SIZE, LOG_TIER2_FILES);
   if (!logger.begin(LOG_DIR, LOG_PREFIX, LOG_EXT, MAX_LOG_FILE_SIZE, MAX_LOG_FILES)) {
     Serial.println(F("Logger init fehlgeschlagen!"));
   } else {
@@ -93,18 +103,36 @@ void setup() {
     Serial.println(logger.currentFilePath());
   }
 
-  web.begin(&latest, &logger, &mqtt);
-  mqtt.begin(&latest);
+  energy.begin(ENERGY_PATH, ENERGY_CHECKPOINT_MS);
 
-  lastSample = millis();
+  if (!events.begin(EVENT_CONFIG_PATH, EVENT_DIR, EVENT_PREFIX, EVENT_FILE_SIZE, EVENT_FILES)) {
+    Serial.println(F("Ereignislog init fehlgeschlagen!"));
+  }
+
+  web.begin(&latest, &logger, &mqtt, &energy, &metrics, &sensor, &events);
+  mqtt.begin(&latest, &energy, &events);
+
+  metrics.reset();
 }
 
 void loop() {
+  // Per-stage timings for /api/metrics (cycle counter, see LoopMetrics)
+  const uint32_t loopStart = metrics.beginLoop();
+  uint32_t t = loopStart;
+
   web.loop();
+  t = metrics.lap(LoopMetrics::Web, t);
   mqtt.loop();
+  t = metrics.lap(LoopMetrics::Mqtt, t);
+  logger.loop();
+  events.loop();
+  t = metrics.lap(LoopMetrics::Logger, t);
+  energy.loop();
+  t = metrics.lap(LoopMetrics::Energy, t);
 
   // mDNS needs regular updates
   MDNS.update();
+  t = metrics.lap(LoopMetrics::Mdns, t);
 
   // Track WiFi state changes to (re)start mDNS on connect
   static wl_status_t lastStatus = WL_IDLE_STATUS;
@@ -137,17 +165,34 @@ void loop() {
     }
     yield(); // be nice to the WDT
   }
-
-  // Sampling & Logging
-  if (millis() - lastSample >= SAMPLE_INTERVAL_MS) {
-    lastSample += SAMPLE_INTERVAL_MS;
-    if (sensor.read(latest)) {
+  t = metrics.lap(LoopMetrics::Wifi, t);
+
+  // Check every new raw sample against the event rules (full sample rate)
+  events.poll(sensor, timeSvc.nowEpoch());
+  t = metrics.lap(LoopMetrics::Sensor, t);
+
+  // The sensor samples on its own timer; drain every completed logging interval
+  while (sensor.intervalReady()) {
+    // samples up to this interval's end must have passed the event rules first
+    events.poll(sensor, timeSvc.nowEpoch());
+    const bool valid = sensor.takeInterval(latest);
+    t = metrics.lap(LoopMetrics::Sensor, t);
+    // Stamp the interval end, not the (possibly delayed) moment of draining
+    const unsigned long age = millis() - latest.ms;
+    metrics.sampleLate(age);
+    if (valid) {
       latest.epoch = timeSvc.nowEpoch();
-      latest.ms    = millis();
-      // compact CSV logger uses "epoch;bus_mV;curr_mA"
+      if (latest.epoch) latest.epoch -= age / 1000;
+      // binary logger stores epoch, bus mV and current mA (8 bytes per sample)
       logger.append(latest, String());
+      energy.add(latest);
+      mqtt.enqueue(latest);
     } else {
       Serial.println(F("Sensor read invalid -> skipped"));
     }
+    metrics.setSensorCounters(sensor.errors(), sensor.overruns());
+    t = metrics.lap(LoopMetrics::Sample, t);
   }
+
+  metrics.endLoop(loopStart);
 }
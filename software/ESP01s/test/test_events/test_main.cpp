@@ -0,0 +1,232 @@
+// Host-Tests für die Regeln von EventDetector (Unity):
+//
+//   pio test -e native
+//
+// Abtastungen laufen den echten Weg: simulierte INA219-Register im
+// Wire-Shim, der Ticker des Sensors wird von Hand ausgelöst, poll() liest
+// den Rohwert-Ring. Bei 0,1 Ω Shunt ist 1 mA = 10 LSB Shuntspannung.
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <Ticker.h>
+#include <Wire.h>
+#include <unity.h>
+#include <vector>
+#include "EventDetector.h"
+#include "SensorINA219.h"
+
+static const uint32_t kEpoch = 1700000000UL;
+static const uint16_t kPeriodMs = 50;
+
+static EventRule rule(EventRule::Kind kind, EventRule::Signal sig, float threshold,
+                      float hysteresis = 0) {
+  EventRule r;
+  r.kind = kind;
+  r.signal = sig;
+  r.threshold = threshold;
+  r.hysteresis = hysteresis;
+  return r;
+}
+
+// Sensor + Detektor mit genau einer Regel; fired sammelt die gemeldeten Ereignisse
+struct Rig {
+  SensorINA219 sensor;
+  EventDetector ev;
+  std::vector<EventRecord> fired;
+
+  explicit Rig(const EventRule& r) {
+    TEST_ASSERT_TRUE(sensor.begin(Wire, kPeriodMs, 16, 5000));
+    TEST_ASSERT_TRUE(ev.begin(nullptr, "/events", "ev_", 4096, 4));
+    EventConfig c;
+    c.rules[0] = r;
+    c.count = 1;
+    TEST_ASSERT_TRUE(ev.setConfig(c));
+    ev.poll(sensor, kEpoch); // ab jetzt
+  }
+
+  // eine Abtastung mit v Volt und mA Milliampere
+  void feed(float v, float mA = 100) {
+    Wire.regs[2] = (uint16_t)(lroundf(v * 250) << 3); // Busregister, LSB 4 mV ab Bit 3
+    Wire.regs[1] = (uint16_t)(int16_t)lroundf(mA * 10);
+    Ticker::shimLast()->shimFire();
+    shimAdvanceMillis(kPeriodMs);
+    ev.poll(sensor, kEpoch);
+    Measurement m;
+    while (sensor.intervalReady()) sensor.takeInterval(m); // Ring freigeben wie loop()
+    EventRecord e;
+    while (ev.peekUnsent(e)) {
+      fired.push_back(e);
+      ev.popUnsent();
+    }
+  }
+
+  void repeat(size_t n, float v, float mA = 100) {
+    for (size_t k = 0; k < n; ++k) feed(v, mA);
+  }
+
+  // true, wenn seit dem letzten Aufruf genau count Ereignisse kamen
+  size_t seen = 0;
+  bool fresh(size_t count) {
+    const bool ok = fired.size() == seen + count;
+    seen = fired.size();
+    return ok;
+  }
+};
+
+void setUp() {
+  LittleFS.setRoot(".pio/test_fs");
+  LittleFS.setTotalBytes(1024 * 1024);
+  LittleFS.format();
+  LittleFS.begin();
+}
+
+void tearDown() {}
+
+// Rising mit Hysterese: kein Ereignis, wenn der Start schon über der
+// Schwelle liegt; wieder scharf erst unter Schwelle - Hysterese
+static void test_rising_hysteresis() {
+  Rig rig(rule(EventRule::Rising, EventRule::Voltage, 12.0f, 1.0f));
+
+  rig.repeat(3, 13.0f);            // Start über der Schwelle
+  TEST_ASSERT_TRUE(rig.fresh(0));
+  rig.feed(11.5f);                 // unter der Schwelle, aber nicht unter 11 V
+  rig.feed(12.5f);
+  TEST_ASSERT_TRUE(rig.fresh(0));
+
+  rig.feed(10.5f);                 // scharf
+  rig.feed(11.9f);
+  TEST_ASSERT_TRUE(rig.fresh(0));
+  rig.feed(12.1f);
+  TEST_ASSERT_TRUE(rig.fresh(1));
+  const EventRecord e = rig.fired.back();
+  TEST_ASSERT_EQUAL_UINT32(EventRule::Rising, e.kind);
+  TEST_ASSERT_EQUAL_UINT32(EventRule::Voltage, e.signal);
+  TEST_ASSERT_EQUAL_UINT32(0, e.rule);
+  TEST_ASSERT_EQUAL_UINT32(12100, e.bus_mV);
+  TEST_ASSERT_EQUAL_UINT32(kEpoch, e.epoch);
+  TEST_ASSERT_FLOAT_WITHIN(0.001, 12.1, e.value);
+
+  // Pendeln um die Schwelle innerhalb der Hysterese: still
+  for (int k = 0; k < 5; ++k) {
+    rig.feed(11.2f);
+    rig.feed(12.6f);
+  }
+  TEST_ASSERT_TRUE(rig.fresh(0));
+
+  rig.feed(10.9f);                 // unter 11 V: wieder scharf
+  rig.feed(12.4f);
+  TEST_ASSERT_TRUE(rig.fresh(1));
+  TEST_ASSERT_FLOAT_WITHIN(0.001, 12.4, rig.fired.back().value);
+  TEST_ASSERT_EQUAL_UINT32(2, rig.ev.count());
+}
+
+// Falling auf dem Strom: Start darunter meldet nicht, wieder scharf erst
+// über Schwelle + Hysterese
+static void test_falling_current_hysteresis() {
+  Rig rig(rule(EventRule::Falling, EventRule::Current, 100.0f, 20.0f));
+
+  rig.repeat(2, 5.0f, 50);         // Start unter der Schwelle
+  rig.feed(5.0f, 110);             // darüber, aber nicht über 120 mA
+  rig.feed(5.0f, 90);
+  TEST_ASSERT_TRUE(rig.fresh(0));
+
+  rig.feed(5.0f, 130);             // scharf
+  rig.feed(5.0f, 101);
+  TEST_ASSERT_TRUE(rig.fresh(0));
+  rig.feed(5.0f, 95);
+  TEST_ASSERT_TRUE(rig.fresh(1));
+  const EventRecord e = rig.fired.back();
+  TEST_ASSERT_EQUAL_UINT32(EventRule::Falling, e.kind);
+  TEST_ASSERT_EQUAL_UINT32(EventRule::Current, e.signal);
+  TEST_ASSERT_EQUAL_INT32(95, e.curr_mA);
+  TEST_ASSERT_FLOAT_WITHIN(0.01, 95, e.value);
+
+  rig.feed(5.0f, 115);             // innerhalb der Hysterese
+  rig.feed(5.0f, 80);
+  TEST_ASSERT_TRUE(rig.fresh(0));
+
+  rig.feed(5.0f, 121);
+  rig.feed(5.0f, -40);             // Rückstrom zählt als darunter
+  TEST_ASSERT_TRUE(rig.fresh(1));
+  TEST_ASSERT_EQUAL_INT32(-40, rig.fired.back().curr_mA);
+}
+
+// Rate: ein Ereignis je Flanke (|Änderung je s| >= Schwelle), nicht je
+// Abtastung; die erste Abtastung hat keinen Vorgänger
+static void test_rate_edges() {
+  Rig rig(rule(EventRule::Rate, EventRule::Voltage, 20.0f)); // 1 V je 50 ms
+
+  rig.feed(20.0f);                 // erster Wert nach dem Start: kein Vergleich
+  rig.repeat(3, 5.0f);             // -300 V/s
+  TEST_ASSERT_TRUE(rig.fresh(1));
+  TEST_ASSERT_FLOAT_WITHIN(0.5, -300, rig.fired.back().value);
+
+  rig.feed(6.5f);                  // +30 V/s
+  TEST_ASSERT_TRUE(rig.fresh(1));
+  const EventRecord e = rig.fired.back();
+  TEST_ASSERT_EQUAL_UINT32(EventRule::Rate, e.kind);
+  TEST_ASSERT_FLOAT_WITHIN(0.1, 30, e.value);
+  rig.feed(8.0f);                  // steigt weiter steil: dieselbe Flanke
+  rig.feed(9.5f);
+  TEST_ASSERT_TRUE(rig.fresh(0));
+
+  rig.feed(9.5f);
+  rig.feed(10.0f);                 // 10 V/s: unter der Schwelle
+  rig.feed(10.9f);                 // 18 V/s
+  TEST_ASSERT_TRUE(rig.fresh(0));
+
+  rig.feed(9.4f);                  // -30 V/s: neue Flanke
+  TEST_ASSERT_TRUE(rig.fresh(1));
+  TEST_ASSERT_FLOAT_WITHIN(0.1, -30, rig.fired.back().value);
+}
+
+// PD-Stufen: erste Stufe nach dem Start still, Wechsel erst nach
+// kPdStableSamples Abtastungen in Folge auf derselben Stufe
+static void test_pd_level_debounce() {
+  static_assert(EventDetector::kPdStableSamples == 3, "Folgen unten sind auf 3 ausgelegt");
+  Rig rig(rule(EventRule::PdLevel, EventRule::Voltage, 0.6f));
+
+  rig.repeat(5, 5.05f);            // erste Stufe: still
+  TEST_ASSERT_TRUE(rig.fresh(0));
+
+  rig.repeat(2, 9.0f);             // zwei Abtastungen reichen nicht
+  rig.feed(5.0f);
+  rig.repeat(2, 9.0f);
+  rig.feed(7.0f);                  // zwischen den Stufen: Zählung beginnt neu
+  rig.repeat(2, 9.0f);
+  TEST_ASSERT_TRUE(rig.fresh(0));
+  rig.feed(9.1f);                  // dritte in Folge (innerhalb der Toleranz)
+  TEST_ASSERT_TRUE(rig.fresh(1));
+  const EventRecord e = rig.fired.back();
+  TEST_ASSERT_EQUAL_UINT32(EventRule::PdLevel, e.kind);
+  TEST_ASSERT_EQUAL_UINT32(5, e.fromV);
+  TEST_ASSERT_FLOAT_WITHIN(0.001, 9, e.value);
+
+  rig.repeat(10, 9.4f);            // bleibt auf 9 V
+  TEST_ASSERT_TRUE(rig.fresh(0));
+
+  rig.repeat(2, 1.0f);             // aus
+  TEST_ASSERT_TRUE(rig.fresh(0));
+  rig.feed(1.0f);
+  TEST_ASSERT_TRUE(rig.fresh(1));
+  TEST_ASSERT_EQUAL_UINT32(9, rig.fired.back().fromV);
+  TEST_ASSERT_FLOAT_WITHIN(0.001, 0, rig.fired.back().value);
+
+  rig.repeat(3, 20.4f);
+  TEST_ASSERT_TRUE(rig.fresh(1));
+  TEST_ASSERT_EQUAL_UINT32(0, rig.fired.back().fromV);
+  TEST_ASSERT_FLOAT_WITHIN(0.001, 20, rig.fired.back().value);
+
+  // gemeldete Ereignisse stehen auch im Ereignislog
+  EventRecord out[8];
+  TEST_ASSERT_EQUAL_UINT32(3, rig.ev.recent(0, out, 8));
+  TEST_ASSERT_EQUAL_UINT32(20, (uint32_t)out[2].value);
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_rising_hysteresis);
+  RUN_TEST(test_falling_current_hysteresis);
+  RUN_TEST(test_rate_edges);
+  RUN_TEST(test_pd_level_debounce);
+  return UNITY_END();
+}
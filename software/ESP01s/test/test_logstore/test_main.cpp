@@ -0,0 +1,330 @@
+// Host-Tests für LogStore (Unity):
+//
+//   pio test -e native
+//
+// Laufen gegen das Shim-Dateisystem unter .pio/test_fs.
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <unity.h>
+#include <vector>
+#include "LogPack.h"
+#include "LogStore.h"
+
+struct __attribute__((packed)) Rec {
+  uint32_t epoch;
+  uint16_t v;
+  int16_t  i;
+};
+
+static Rec makeRec(uint32_t k) {
+  Rec r;
+  r.epoch = 1700000000 + k * 5;
+  r.v = (uint16_t)(5000 + k % 40);
+  r.i = (int16_t)(k % 7 * 100 - 300);
+  return r;
+}
+
+static std::vector<Rec> readAll(LogStore& s) {
+  s.flush();
+  std::vector<Rec> out;
+  LogReader rd(s, LogCursor());
+  Rec buf[7];
+  size_t n;
+  while ((n = rd.read(buf, 7)) > 0) out.insert(out.end(), buf, buf + n);
+  return out;
+}
+
+// Gelesen wird ein lückenloses Ende von makeRec(0..n-1): ältere Sätze dürfen
+// fehlen, aber keiner verschoben oder mittendrin verworfen sein
+static void assertNewestTail(LogStore& s, uint32_t n) {
+  const std::vector<Rec> got = readAll(s);
+  TEST_ASSERT_TRUE(got.size() > 0 && got.size() < n);
+  const uint32_t first = n - got.size();
+  for (size_t k = 0; k < got.size(); ++k) {
+    const Rec r = makeRec(first + k);
+    TEST_ASSERT_EQUAL_MEMORY(&r, &got[k], sizeof(Rec));
+  }
+}
+
+void setUp() {
+  LittleFS.setRoot(".pio/test_fs");
+  LittleFS.setTotalBytes(1024 * 1024);
+  LittleFS.setEnforceSize(false);
+  LittleFS.setFailTruncate(false);
+  LittleFS.format();
+  LittleFS.begin();
+}
+
+void tearDown() {}
+
+// Stromausfall zwischen packSegment() und createNewFile() beim Rotieren:
+// jüngste Datei ist gepackt. begin() darf sie nicht fortschreiben, sonst
+// liegen die neuen Sätze hinter dem gepackten Strom und sind unlesbar.
+static void test_packed_newest_segment_not_appended() {
+  std::vector<Rec> expect;
+  {
+    LogStore a;
+    a.setPacking(true);
+    TEST_ASSERT_TRUE(a.begin("/t", "x_", ".bin", sizeof(Rec), 1024, 40));
+    uint32_t k = 0;
+    while (a.segmentCount() < 3) {
+      const Rec r = makeRec(k++);
+      TEST_ASSERT_TRUE(a.append(&r));
+    }
+    TEST_ASSERT_TRUE(a.flush());
+    // aktuelle (leere/ungepackte) Datei entfernen: Zustand direkt nach dem Packen
+    TEST_ASSERT_TRUE(LittleFS.remove(a.currentFilePath()));
+    expect = readAll(a);
+    TEST_ASSERT_TRUE(expect.size() > 0);
+  }
+
+  LogStore b;
+  b.setPacking(true);
+  TEST_ASSERT_TRUE(b.begin("/t", "x_", ".bin", sizeof(Rec), 1024, 40));
+  TEST_ASSERT_FALSE(b.segment(b.segmentCount() - 1).packed);
+  TEST_ASSERT_TRUE(b.segment(b.segmentCount() - 2).packed);
+
+  const uint32_t base = expect.back().epoch;
+  for (uint32_t k = 1; k <= 20; ++k) {
+    Rec r = makeRec(k);
+    r.epoch = base + k * 5;
+    TEST_ASSERT_TRUE(b.append(&r));
+    expect.push_back(r);
+  }
+  const std::vector<Rec> got = readAll(b);
+  TEST_ASSERT_EQUAL_UINT32(expect.size(), got.size());
+  TEST_ASSERT_EQUAL_MEMORY(expect.data(), got.data(), expect.size() * sizeof(Rec));
+}
+
+// Dateisystem voll, bevor die aktuelle Datei ihre Größe erreicht: flush()
+// muss das älteste Segment opfern, statt den Logger anzuhalten.
+static void test_full_fs_drops_oldest() {
+  LittleFS.setTotalBytes(4000);
+  LittleFS.setEnforceSize(true);
+
+  LogStore s;
+  TEST_ASSERT_TRUE(s.begin("/t", "x_", ".bin", sizeof(Rec), 1024, 40));
+  const uint32_t n = 1000; // ~9 KB bei 9 Byte je Satz
+  for (uint32_t k = 0; k < n; ++k) {
+    const Rec r = makeRec(k);
+    TEST_ASSERT_TRUE(s.append(&r));
+  }
+
+  assertNewestTail(s, n);
+}
+
+// Halber Satz bei vollem Dateisystem, und truncate() scheitert: danach darf
+// nichts hinter dem Rest landen, sonst stünden alle folgenden Sätze verschoben.
+static void test_failed_truncate_keeps_alignment() {
+  LittleFS.setTotalBytes(4000);
+  LittleFS.setEnforceSize(true);
+  LittleFS.setFailTruncate(true);
+
+  LogStore s;
+  TEST_ASSERT_TRUE(s.begin("/t", "x_", ".bin", sizeof(Rec), 1024, 40));
+  const uint32_t n = 1000;
+  for (uint32_t k = 0; k < n; ++k) {
+    const Rec r = makeRec(k);
+    TEST_ASSERT_TRUE(s.append(&r));
+  }
+
+  assertNewestTail(s, n);
+
+  // Stromausfall mitten im Satz, und beim Start scheitert truncate() ebenfalls
+  LittleFS.setEnforceSize(false);
+  {
+    File f = LittleFS.open(s.currentFilePath(), "a");
+    const uint8_t torn[5] = {1, 2, 3, 4, 5};
+    TEST_ASSERT_EQUAL_UINT32(sizeof(torn), f.write(torn, sizeof(torn)));
+  }
+  LogStore b;
+  TEST_ASSERT_TRUE(b.begin("/t", "x_", ".bin", sizeof(Rec), 1024, 40));
+  const uint32_t m = n + 200;
+  for (uint32_t k = n; k < m; ++k) {
+    const Rec r = makeRec(k);
+    TEST_ASSERT_TRUE(b.append(&r));
+  }
+
+  assertNewestTail(b, m);
+}
+
+// Packt recs in eine Datei und liest sie mit LogUnpacker zurück; liefert die
+// Größe des kodierten Stroms
+static size_t packRoundTrip(const std::vector<Rec>& recs) {
+  LogPacker pk;
+  TEST_ASSERT_TRUE(pk.begin(sizeof(Rec)));
+  uint8_t enc[LogPacker::kMaxOut];
+  size_t bytes = 0;
+  File f = LittleFS.open("/pack.bin", "w");
+  for (const Rec& r : recs) {
+    const size_t n = pk.add((const uint8_t*)&r, enc);
+    TEST_ASSERT_TRUE(n <= LogPacker::kMaxOut);
+    bytes += f.write(enc, n);
+  }
+  bytes += f.write(enc, pk.finish(enc));
+  f.close();
+
+  LogUnpacker up;
+  up.begin(sizeof(Rec), recs.size());
+  f = LittleFS.open("/pack.bin", "r");
+  std::vector<Rec> got;
+  Rec buf[7];
+  size_t used;
+  do {
+    const size_t n = up.read(f, (uint8_t*)buf, 7, used);
+    TEST_ASSERT_EQUAL_UINT32(used, n); // keine leeren Plätze
+    got.insert(got.end(), buf, buf + n);
+  } while (used > 0);
+  TEST_ASSERT_EQUAL_UINT32(recs.size(), got.size());
+  TEST_ASSERT_EQUAL_MEMORY(recs.data(), got.data(), recs.size() * sizeof(Rec));
+  return bytes;
+}
+
+// Randfälle der Kodierung: epoch 0 (nicht synchron) mitten im Strom, negative
+// und über 16 Bit umlaufende Wort-Deltas, Sprünge der epoch in beide Richtungen
+static void test_pack_roundtrip_edge_cases() {
+  std::vector<Rec> recs;
+  recs.push_back(Rec{0, 5000, 100});            // vor der Zeitsynchronisation
+  recs.push_back(Rec{0, 5001, 100});
+  recs.push_back(Rec{1700000000, 5001, 100});   // Sprung von 0 auf echte Zeit
+  recs.push_back(Rec{1700000005, 4000, -100});  // negative Deltas
+  recs.push_back(Rec{1700000010, 65535, 32767});
+  recs.push_back(Rec{1700000015, 0, -32768});   // Umlauf 65535 -> 0, 32767 -> -32768
+  recs.push_back(Rec{1700000020, 65535, 32767}); // und zurück
+  recs.push_back(Rec{0, 1, 1});                 // Zeit verloren: epoch rückwärts auf 0
+  recs.push_back(Rec{0xFFFFFFFFu, 2, 2});       // größte epoch
+  recs.push_back(Rec{1700000030, 2, 2});
+  recs.push_back(Rec{1700000025, 2, 2});        // epoch rückwärts
+  packRoundTrip(recs);
+
+  // einzelner Satz, nur Wiederholungen nach dem ersten
+  packRoundTrip(std::vector<Rec>{ Rec{1700000000, 7, 7} });
+}
+
+// Lange Läufe gleicher Sätze im festen Raster gehen in einem Token auf, auch
+// wenn der Lauf den Strom beendet (finish) oder mitten drin abbricht
+static void test_pack_long_runs() {
+  std::vector<Rec> recs;
+  for (uint32_t k = 0; k < 1000; ++k) recs.push_back(Rec{1700000000 + k * 5, 5000, 0});
+  // zwei ausgeschriebene Sätze (Start der epoch-Deltas), dann ein Token, das
+  // erst finish() ausgibt
+  TEST_ASSERT_TRUE(packRoundTrip(recs) < 24);
+
+  recs.push_back(Rec{1700005000, 5100, 20});   // Lauf bricht ab
+  for (uint32_t k = 1; k < 300; ++k) recs.push_back(Rec{1700005000 + k * 5, 5100, 20});
+  recs.push_back(Rec{1700007000, 5100, 20});   // gleiche Werte, anderer Schritt
+  TEST_ASSERT_TRUE(packRoundTrip(recs) < 40);
+}
+
+// Gepackte Segmente liefern über LogReader und findFirst dasselbe wie
+// ungepackte: gleiche Sätze, gleiche Cursor
+static void test_packed_segments_read_like_plain() {
+  LogStore plain, packed;
+  packed.setPacking(true);
+  TEST_ASSERT_TRUE(plain.begin("/plain", "x_", ".bin", sizeof(Rec), 1024, 40));
+  TEST_ASSERT_TRUE(packed.begin("/packed", "x_", ".bin", sizeof(Rec), 1024, 40));
+  for (uint32_t k = 0; k < 700; ++k) {
+    // Lücken und Läufe gemischt, epoch streng steigend
+    Rec r = makeRec(k);
+    r.epoch = 1700000000 + k * 5 + (k / 100) * 3600;
+    if (k % 50 < 20) { r.v = 5000; r.i = 0; }
+    TEST_ASSERT_TRUE(plain.append(&r));
+    TEST_ASSERT_TRUE(packed.append(&r));
+  }
+  TEST_ASSERT_TRUE(packed.segmentCount() > 2);
+  TEST_ASSERT_EQUAL_UINT32(plain.segmentCount(), packed.segmentCount());
+  for (size_t i = 0; i + 1 < packed.segmentCount(); ++i) {
+    TEST_ASSERT_TRUE(packed.segment(i).packed);
+    TEST_ASSERT_TRUE(packed.segment(i).size < plain.segment(i).size);
+    TEST_ASSERT_EQUAL_UINT32(plain.segmentRecords(i), packed.segmentRecords(i));
+    TEST_ASSERT_EQUAL_UINT32(plain.segment(i).firstEpoch, packed.segment(i).firstEpoch);
+    TEST_ASSERT_EQUAL_UINT32(plain.segment(i).lastEpoch, packed.segment(i).lastEpoch);
+  }
+
+  const std::vector<Rec> a = readAll(plain), b = readAll(packed);
+  TEST_ASSERT_EQUAL_UINT32(a.size(), b.size());
+  TEST_ASSERT_EQUAL_MEMORY(a.data(), b.data(), a.size() * sizeof(Rec));
+
+  // findFirst auf Satzgrenzen, zwischen Sätzen, in Lücken, davor und dahinter
+  const uint32_t probes[] = { 0, 1700000000, 1700000001, 1700000495, 1700000500,
+                              1700002000, 1700004100, a.back().epoch, a.back().epoch + 1 };
+  for (uint32_t t : probes) {
+    LogCursor ca, cb;
+    const bool fa = plain.findFirst(t, ca), fb = packed.findFirst(t, cb);
+    TEST_ASSERT_EQUAL_UINT32(fa, fb);
+    if (!fa) continue;
+    TEST_ASSERT_EQUAL_UINT32(ca.seg, cb.seg);
+    TEST_ASSERT_EQUAL_UINT32(ca.rec, cb.rec);
+    Rec ra, rb;
+    LogReader rda(plain, ca), rdb(packed, cb);
+    TEST_ASSERT_EQUAL_UINT32(1, rda.read(&ra, 1));
+    TEST_ASSERT_EQUAL_UINT32(1, rdb.read(&rb, 1));
+    TEST_ASSERT_EQUAL_MEMORY(&ra, &rb, sizeof(Rec));
+    TEST_ASSERT_TRUE(ra.epoch >= t);
+  }
+}
+
+// Beschädigter Satz beim Versiegeln: die übrigen behalten ihre Satznummern,
+// ein vor der Rotation gemerkter Cursor setzt also genau dort fort
+static void test_pack_keeps_record_numbers() {
+  LogStore s;
+  s.setPacking(true);
+  TEST_ASSERT_TRUE(s.begin("/t", "x_", ".bin", sizeof(Rec), 1024, 40));
+  const int seg = s.segment(0).index;
+  uint32_t k = 0;
+  for (; k < 40; ++k) {
+    const Rec r = makeRec(k);
+    TEST_ASSERT_TRUE(s.append(&r));
+  }
+  TEST_ASSERT_TRUE(s.flush());
+
+  // Satz 5 kippt im Flash, ein Client hält Cursor hinter Satz 10
+  {
+    File f = LittleFS.open(s.currentFilePath(), "r+");
+    TEST_ASSERT_TRUE(f.seek(LogStore::recordOffset(5, sizeof(Rec) + 1) + 4));
+    const uint8_t junk = 0xA5;
+    f.write(&junk, 1);
+  }
+  LogCursor held;
+  held.seg = seg;
+  held.rec = 10;
+
+  while (s.segmentCount() < 2) {
+    const Rec r = makeRec(k++);
+    TEST_ASSERT_TRUE(s.append(&r));
+  }
+  TEST_ASSERT_TRUE(s.segment(0).packed);
+  TEST_ASSERT_TRUE(s.flush());
+
+  Rec r;
+  LogReader rd(s, held);
+  TEST_ASSERT_EQUAL_UINT32(1, rd.read(&r, 1));
+  const Rec want = makeRec(10);
+  TEST_ASSERT_EQUAL_MEMORY(&want, &r, sizeof(Rec));
+
+  // findFirst zählt den leeren Platz mit
+  LogCursor c;
+  TEST_ASSERT_TRUE(s.findFirst(makeRec(20).epoch, c));
+  TEST_ASSERT_EQUAL_UINT32(seg, c.seg);
+  TEST_ASSERT_EQUAL_UINT32(20, c.rec);
+
+  // alles lesen: nur Satz 5 fehlt
+  const std::vector<Rec> got = readAll(s);
+  TEST_ASSERT_EQUAL_UINT32(k - 1, got.size());
+  for (size_t j = 0; j < got.size(); ++j) {
+    const Rec e = makeRec(j < 5 ? j : j + 1);
+    TEST_ASSERT_EQUAL_MEMORY(&e, &got[j], sizeof(Rec));
+  }
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_packed_newest_segment_not_appended);
+  RUN_TEST(test_full_fs_drops_oldest);
+  RUN_TEST(test_failed_truncate_keeps_alignment);
+  RUN_TEST(test_pack_roundtrip_edge_cases);
+  RUN_TEST(test_pack_long_runs);
+  RUN_TEST(test_packed_segments_read_like_plain);
+  RUN_TEST(test_pack_keeps_record_numbers);
+  return UNITY_END();
+}
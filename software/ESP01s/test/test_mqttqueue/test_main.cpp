@@ -0,0 +1,102 @@
+// Host-Tests für MqttQueue (Unity):
+//
+//   pio test -e native
+//
+// Laufen gegen das Shim-Dateisystem unter .pio/test_fs.
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <unity.h>
+#include <vector>
+#include "MqttQueue.h"
+
+static const char* kDir = "/mqttq";
+
+static QueuedSample sample(uint32_t t) {
+  QueuedSample q;
+  q.t = t;
+  q.mV = (uint16_t)(5000 + t % 100);
+  q.mA = (int16_t)(t % 50);
+  q.mW = (int32_t)t;
+  return q;
+}
+
+// Sendet höchstens batches Blöcke à 20 Sätze (peek + pop) und hängt die
+// Zeitstempel an sent an
+static void drain(MqttQueue& q, std::vector<uint32_t>& sent, size_t batches = (size_t)-1) {
+  QueuedSample b[20];
+  for (size_t k = 0; k < batches && !q.empty(); ++k) {
+    const size_t n = q.peek(b, 20);
+    if (n == 0) break;
+    for (size_t j = 0; j < n; ++j) sent.push_back(b[j].t);
+    q.pop(n);
+  }
+}
+
+void setUp() {
+  LittleFS.setRoot(".pio/test_fs");
+  LittleFS.setTotalBytes(1024 * 1024);
+  LittleFS.format();
+  LittleFS.begin();
+}
+
+void tearDown() {}
+
+// Neustart mitten im Nachliefern: bereits gesendete Blöcke aus dem Flash
+// kommen nicht noch einmal, der Rest lückenlos
+static void test_spill_reboot_drain() {
+  std::vector<uint32_t> sent;
+  uint32_t spilled;
+  {
+    MqttQueue q;
+    TEST_ASSERT_TRUE(q.begin(kDir, 4096, 4));
+    for (uint32_t t = 1; t <= 500; ++t) q.push(sample(t));
+    TEST_ASSERT_TRUE(q.hasBacklog());
+    spilled = q.spillCount();
+    TEST_ASSERT_TRUE(spilled > 100);
+    drain(q, sent, 3); // drei Blöcke aus dem Flash bestätigt
+    TEST_ASSERT_TRUE(sent.size() > 20 && sent.size() < spilled);
+  } // Stromausfall: RAM-Teil ist verloren
+
+  MqttQueue q;
+  TEST_ASSERT_TRUE(q.begin(kDir, 4096, 4));
+  TEST_ASSERT_TRUE(q.hasBacklog());
+  drain(q, sent);
+  TEST_ASSERT_TRUE(q.empty());
+
+  // genau die ausgelagerten Sätze, jeder einmal, in Reihenfolge
+  TEST_ASSERT_EQUAL_UINT32(spilled, sent.size());
+  for (size_t k = 0; k < sent.size(); ++k) TEST_ASSERT_EQUAL_UINT32(k + 1, sent[k]);
+
+  // vollständig gesendet: nach einem weiteren Neustart ist nichts mehr offen
+  MqttQueue again;
+  TEST_ASSERT_TRUE(again.begin(kDir, 4096, 4));
+  TEST_ASSERT_TRUE(again.empty());
+}
+
+// Neustart, bevor etwas gesendet wurde, und nach dem Leeren neu ausgelagert:
+// die alte Position darf den neuen Bestand nicht überspringen
+static void test_spill_reboot_after_clear() {
+  std::vector<uint32_t> sent;
+  {
+    MqttQueue q;
+    TEST_ASSERT_TRUE(q.begin(kDir, 4096, 4));
+    for (uint32_t t = 1; t <= 200; ++t) q.push(sample(t));
+    drain(q, sent); // Flash und RAM vollständig
+    TEST_ASSERT_EQUAL_UINT32(200, sent.size());
+    for (uint32_t t = 1001; t <= 1200; ++t) q.push(sample(t));
+  }
+  sent.clear();
+  MqttQueue q;
+  TEST_ASSERT_TRUE(q.begin(kDir, 4096, 4));
+  drain(q, sent);
+  TEST_ASSERT_TRUE(sent.size() > 0);
+  TEST_ASSERT_EQUAL_UINT32(1001, sent.front());
+  for (size_t k = 1; k < sent.size(); ++k) TEST_ASSERT_EQUAL_UINT32(sent[k - 1] + 1, sent[k]);
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_spill_reboot_drain);
+  RUN_TEST(test_spill_reboot_after_clear);
+  return UNITY_END();
+}
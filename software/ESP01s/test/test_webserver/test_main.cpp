@@ -0,0 +1,170 @@
+// Host-Tests für die Log-Antworten von WebServerMgr (Unity):
+//
+//   pio test -e native
+//
+// Requests gehen über den Server-Shim, Antworten werden aus dem Sendepuffer
+// des Host-Clients entchunkt. Die Daten liegen in der Zukunft, damit Fenster
+// und Bucketbreite nicht von der Uhr des Hosts abhängen.
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <LittleFS.h>
+#include <unity.h>
+#include <functional>
+#include <string>
+#include "Config.h"
+#include "DataLogger.h"
+#include "WebServerMgr.h"
+
+static const uint32_t kBase = 4000000020UL; // durch 60 und 900 teilbar
+
+static void setupLogger(DataLogger& lg) {
+  lg.setFlushPolicy(LOG_FLUSH_RECORDS, LOG_FLUSH_MS);
+  lg.setPacking(LOG_PACK_SEGMENTS);
+  lg.addTier(LOG_TIER1_PREFIX, LOG_TIER1_PERIOD_S, LOG_TIER_FILE_SIZE, LOG_TIER1_FILES);
+  lg.addTier(LOG_TIER2_PREFIX, LOG_TIER2_PERIOD_S, LOG_TIER_FILE_SIZE, LOG_TIER2_FILES);
+}
+
+// Messwert k im 5-s-Raster (feste Werte, kein Zufall)
+static Measurement sample(uint32_t k) {
+  Measurement m;
+  m.epoch = kBase + k * 5;
+  m.busV = 5.0f + (k % 17) * 0.1f;
+  m.currmA = 100.0f + (k % 29) * 10.0f;
+  m.powermW = m.busV * m.currmA;
+  m.samples = 1;
+  return m;
+}
+
+// Rumpf einer Chunked-Antwort (Kopfzeilen abgetrennt)
+static std::string body(const std::string& tx) {
+  size_t p = tx.find("\r\n\r\n");
+  if (p == std::string::npos) return std::string();
+  p += 4;
+  std::string out;
+  while (p < tx.size()) {
+    const size_t eol = tx.find("\r\n", p);
+    if (eol == std::string::npos) break;
+    const size_t len = strtoul(tx.substr(p, eol - p).c_str(), nullptr, 16);
+    if (len == 0) break;
+    out += tx.substr(eol + 2, len);
+    p = eol + 2 + len + 2;
+  }
+  return out;
+}
+
+// GET uri; between() läuft nach dem ersten loop(), während die Antwort noch entsteht
+static std::string get(WebServerMgr& web, const String& uri,
+                       const std::vector<std::pair<String, String>>& args,
+                       const std::function<void()>& between = nullptr) {
+  ESP8266WebServer& srv = *ESP8266WebServer::shimLast();
+  WiFiClient c = srv.shimRequest(HTTP_GET, uri, args);
+  web.loop();
+  if (between) {
+    TEST_ASSERT_TRUE(web.activeStreams() > 0); // mehr als ein Chunk, sonst prüft between() nichts
+    between();
+  }
+  while (web.activeStreams()) web.loop();
+  return body(c.context()->tx);
+}
+
+void setUp() {
+  LittleFS.setRoot(".pio/test_fs");
+  LittleFS.setTotalBytes(1024 * 1024);
+  LittleFS.format();
+  LittleFS.begin();
+}
+
+void tearDown() {}
+
+// Rollt die Stufe über, während /api/logs/agg noch läuft, muss die Antwort
+// dem Stand beim Aufruf entsprechen: die abgeschlossene Periode fehlt nicht,
+// die neue kommt nicht hinzu.
+static void test_agg_stable_across_tier_rollover() {
+  DataLogger lg;
+  setupLogger(lg);
+  TEST_ASSERT_TRUE(lg.begin(LOG_DIR, LOG_PREFIX, LOG_EXT, MAX_LOG_FILE_SIZE, MAX_LOG_FILES));
+  const uint32_t n = 6 * 720 + 3; // 6 h, letzte Minute offen (3 Sätze)
+  for (uint32_t k = 0; k < n; ++k) lg.append(sample(k), String());
+
+  WebServerMgr web(80);
+  web.begin(nullptr, &lg, nullptr, nullptr);
+  const std::vector<std::pair<String, String>> args = { { "sec", "max" }, { "points", "300" } };
+
+  const std::string before = get(web, "/api/logs/agg", args);
+  uint32_t k = n;
+  const std::string during = get(web, "/api/logs/agg", args, [&] {
+    for (uint32_t end = k + 12; k < end; ++k) lg.append(sample(k), String()); // nächste Minute
+  });
+  TEST_ASSERT_TRUE(before.size() > 512);
+  TEST_ASSERT_EQUAL_UINT32(before.size(), during.size());
+  TEST_ASSERT_TRUE(before == during);
+}
+
+// Messwert mit festen Werten zur Zeit kBase + dt
+static Measurement point(uint32_t dt, float busV, float currmA) {
+  Measurement m;
+  m.epoch = kBase + dt;
+  m.busV = busV;
+  m.currmA = currmA;
+  m.powermW = busV * currmA;
+  m.samples = 1;
+  return m;
+}
+
+static void assertSeries(JsonObjectConst o, double avg, double sd, long mn, uint32_t mnAt,
+                         long mx, uint32_t mxAt) {
+  TEST_ASSERT_FLOAT_WITHIN(0.001, avg, o["avg"].as<double>());
+  TEST_ASSERT_FLOAT_WITHIN(0.001, sd, o["sd"].as<double>());
+  TEST_ASSERT_EQUAL_INT32(mn, o["min"].as<long>());
+  TEST_ASSERT_EQUAL_UINT32(kBase + mnAt, o["minAt"].as<uint32_t>());
+  TEST_ASSERT_EQUAL_INT32(mx, o["max"].as<long>());
+  TEST_ASSERT_EQUAL_UINT32(kBase + mxAt, o["maxAt"].as<uint32_t>());
+}
+
+// /api/logs/stats über eine feste Reihe mit nachgerechneten Werten: Sätze
+// vor from und nach to zählen nicht, 61 s Abstand ist eine Lücke (nicht
+// integriert), genau 60 s noch nicht.
+static void test_stats_known_series() {
+  DataLogger lg;
+  setupLogger(lg);
+  TEST_ASSERT_TRUE(lg.begin(LOG_DIR, LOG_PREFIX, LOG_EXT, MAX_LOG_FILE_SIZE, MAX_LOG_FILES));
+  lg.append(point(0, 9.0f, 2000), String());    // vor from
+  lg.append(point(10, 5.0f, 100), String());    //  500 mW
+  lg.append(point(20, 5.0f, 200), String());    // 1000 mW
+  lg.append(point(30, 5.1f, 300), String());    // 1530 mW
+  lg.append(point(91, 5.0f, 100), String());    //  500 mW, 61 s: Lücke
+  lg.append(point(151, 4.9f, -100), String());  // -490 mW, 60 s: integriert
+  lg.append(point(300, 9.0f, 2000), String());  // nach to
+
+  WebServerMgr web(80);
+  web.begin(nullptr, &lg, nullptr, nullptr);
+  const std::string out = get(web, "/api/logs/stats", {
+    { "from", String(kBase + 10) }, { "to", String(kBase + 200) } });
+
+  DynamicJsonDocument doc(1024);
+  TEST_ASSERT_TRUE(deserializeJson(doc, out.c_str()) == DeserializationError::Ok);
+  TEST_ASSERT_EQUAL_UINT32(kBase + 10, doc["from"].as<uint32_t>());
+  TEST_ASSERT_EQUAL_UINT32(kBase + 200, doc["to"].as<uint32_t>());
+  TEST_ASSERT_EQUAL_UINT32(5, doc["n"].as<uint32_t>());
+  TEST_ASSERT_EQUAL_UINT32(kBase + 10, doc["first"].as<uint32_t>());
+  TEST_ASSERT_EQUAL_UINT32(kBase + 151, doc["last"].as<uint32_t>());
+  TEST_ASSERT_EQUAL_UINT32(1, doc["gaps"].as<uint32_t>());
+  TEST_ASSERT_EQUAL_UINT32(10 + 10 + 60, doc["covered"].as<uint32_t>());
+
+  // Trapez: (500+1000)/2*10 + (1000+1530)/2*10 + (500-490)/2*60 = 20450 mWs
+  TEST_ASSERT_FLOAT_WITHIN(0.001, 5.68, doc["mWh"].as<double>());
+  // (100+200)/2*10 + (200+300)/2*10 + (100-100)/2*60 = 4000 mAs
+  TEST_ASSERT_FLOAT_WITHIN(0.001, 1.11, doc["mAh"].as<double>());
+
+  // Stichproben-Standardabweichung: sqrt(Summe der Abweichungsquadrate / 4)
+  assertSeries(doc["bus_mV"], 5000, 70.7, 4900, 151, 5100, 30);      // sqrt(20000/4)
+  assertSeries(doc["curr_mA"], 120, 148.3, -100, 151, 300, 30);      // sqrt(88000/4)
+  assertSeries(doc["power_mW"], 608, 747.1, -490, 151, 1530, 30);    // sqrt(2232680/4)
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_agg_stable_across_tier_rollover);
+  RUN_TEST(test_stats_known_series);
+  return UNITY_END();
+}